@@ -0,0 +1,427 @@
+#include "acknowledged_link.h"
+#include "upload_protocol.h"
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <thread>
+
+using namespace fpga_ticker_client;
+
+#ifdef __unix__
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+    // Sequence numbers wrap, so distance is taken modulo 256
+    size_t sequence_distance(const uint8_t from, const uint8_t to)
+    {
+        return static_cast<uint8_t>(to - from);
+    }
+
+    void put_checksum(std::vector<uint8_t>& bytes)
+    {
+        const size_t offset = sizeof(link_packet::magic);
+        const uint32_t checksum = crc32(bytes.data() + offset, bytes.size() - offset);
+        for (size_t byte_no = 0; byte_no < link_packet::checksum_size; ++byte_no) {
+            bytes.push_back(static_cast<uint8_t>(checksum >> (8 * byte_no)));
+        }
+    }
+}
+
+std::vector<uint8_t> link_packet::serialize(const uint8_t sequence, const uint8_t* payload, const size_t count)
+{
+    if ((count == 0) || (count > max_payload)) {
+        throw std::invalid_argument("Packet payload must be 1.." + std::to_string(max_payload) + " bytes");
+    }
+
+    std::vector<uint8_t> bytes;
+    bytes.reserve(header_size + count + checksum_size);
+    bytes.insert(bytes.end(), std::begin(magic), std::end(magic));
+    bytes.push_back(sequence);
+    bytes.push_back(static_cast<uint8_t>(count));
+    bytes.push_back(static_cast<uint8_t>(~count));
+    bytes.insert(bytes.end(), payload, payload + count);
+    put_checksum(bytes);
+    return bytes;
+}
+
+std::string link_statistics::to_string() const
+{
+    std::ostringstream stream;
+    stream << "packets: " << packets
+        << ", retransmissions: " << retransmissions
+        << ", naks: " << naks
+        << ", timeouts: " << timeouts
+        << ", delivered bytes: " << delivered_bytes
+        << ", delivered bytes/s: " << static_cast<uint64_t>(delivered_bytes_per_second)
+        << ", mean round trip: " << std::chrono::duration_cast<std::chrono::microseconds>(mean_round_trip).count()
+        << " us";
+    return stream.str();
+}
+
+acknowledged_link::acknowledged_link(const std::shared_ptr<serial_device>& device, const link_options& options)
+    : device(device), options(options), next_sequence(0), unanswered_retries(0), reply(), reply_size(0),
+    round_trip_sum(std::chrono::nanoseconds::zero()), round_trips(0), cancelled(false)
+{
+    if ((options.window == 0) || (options.window > 127)) {
+        throw std::invalid_argument("Window must hold 1..127 packets");
+    }
+    if (options.timeout <= std::chrono::milliseconds::zero()) {
+        throw std::invalid_argument("Acknowledgement timeout must be positive");
+    }
+    if (!device->is_opened()) {
+        throw std::logic_error("Device is not opened");
+    }
+
+#ifdef __unix__
+    if (pipe(cancel_pipe) == -1) {
+        throw std::runtime_error("Error creating cancellation pipe: " + std::to_string(errno));
+    }
+    for (const int descriptor : cancel_pipe) {
+        fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL) | O_NONBLOCK);
+        fcntl(descriptor, F_SETFD, FD_CLOEXEC);
+    }
+#endif
+}
+
+acknowledged_link::~acknowledged_link()
+{
+#ifdef __unix__
+    close(cancel_pipe[0]);
+    close(cancel_pipe[1]);
+#endif
+}
+
+bool acknowledged_link::try_send(const uint8_t* payload, const size_t count)
+{
+    if (cancelled) {
+        return false;
+    }
+    read_replies();
+    if (window.size() >= options.window) {
+        return false;
+    }
+
+    packet sent_packet = { next_sequence, count, 0, link_packet::serialize(next_sequence, payload, count), { } };
+    device->write_bytes(sent_packet.bytes.data(), sent_packet.bytes.size());
+    sent_packet.sent = clock::now();
+    if (statistics.packets++ == 0) {
+        first_send = sent_packet.sent;
+    }
+    ++next_sequence;
+    window.push_back(std::move(sent_packet));
+    return true;
+}
+
+bool acknowledged_link::send(const uint8_t* payload, const size_t count)
+{
+    while (!try_send(payload, count)) {
+        if (!process(clock::time_point::max(), options.window - 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool acknowledged_link::process_until(const clock::time_point& deadline)
+{
+    return process(deadline, 0);
+}
+
+bool acknowledged_link::flush()
+{
+    return process(clock::time_point::max(), 0);
+}
+
+bool acknowledged_link::process(const clock::time_point& deadline, const size_t target_in_flight)
+{
+    while (true) {
+        if (cancelled) {
+            return false;
+        }
+        read_replies();
+        if (window.size() <= target_in_flight) {
+            return true;
+        }
+
+        const clock::time_point retransmit_time = window.front().sent + options.timeout;
+        if (clock::now() >= retransmit_time) {
+            ++statistics.timeouts;
+            resend_all();
+            continue;
+        }
+        if (!wait_readable(std::min(deadline, retransmit_time))) {
+            if (cancelled) {
+                return false;
+            }
+            if (clock::now() >= deadline) {
+                return true;
+            }
+        }
+    }
+}
+
+void acknowledged_link::read_replies()
+{
+    uint8_t bytes[64];
+    size_t count;
+    while ((count = device->read_available(bytes, sizeof(bytes))) != 0) {
+        for (size_t byte_no = 0; byte_no < count; ++byte_no) {
+            // Anything but ACK or NAK where reply should start is line noise
+            if ((reply_size == 0) && (bytes[byte_no] != link_packet::ack) && (bytes[byte_no] != link_packet::nak)) {
+                continue;
+            }
+            reply[reply_size++] = bytes[byte_no];
+            if (reply_size == reply.size()) {
+                reply_size = 0;
+                handle_reply(reply[0], reply[1]);
+            }
+        }
+    }
+}
+
+void acknowledged_link::handle_reply(const uint8_t type, const uint8_t sequence)
+{
+    if (window.empty()) {
+        return;
+    }
+
+    if (type == link_packet::ack) {
+        acknowledge_through(sequence);
+        return;
+    }
+
+    // NAK names the packet board expects, everything before it has arrived
+    const size_t distance = sequence_distance(window.front().sequence, sequence);
+    if (distance > window.size()) {
+        return;
+    }
+    ++statistics.naks;
+    if (distance != 0) {
+        acknowledge_through(static_cast<uint8_t>(sequence - 1));
+    }
+    if (!window.empty()) {
+        resend_all();
+    }
+}
+
+void acknowledged_link::acknowledge_through(const uint8_t sequence)
+{
+    const size_t distance = sequence_distance(window.front().sequence, sequence);
+    // Repeated acknowledgement of a packet that already left the window
+    if (distance >= window.size()) {
+        return;
+    }
+
+    const clock::time_point now = clock::now();
+    for (size_t packet_no = 0; packet_no <= distance; ++packet_no) {
+        const packet& acknowledged = window.front();
+        // Round trip of a retransmitted packet is ambiguous, so only first transmissions are measured
+        if (acknowledged.retries == 0) {
+            round_trip_sum += std::chrono::duration_cast<std::chrono::nanoseconds>(now - acknowledged.sent);
+            ++round_trips;
+        }
+        statistics.delivered_bytes += acknowledged.payload_size;
+        window.pop_front();
+    }
+    last_delivery = now;
+    unanswered_retries = 0;
+}
+
+void acknowledged_link::resend_all()
+{
+    // Packets behind a damaged one are resent with it, so only retransmissions without any progress count
+    if (unanswered_retries++ >= options.max_retries) {
+        throw std::runtime_error("Packet " + std::to_string(window.front().sequence) + " was not acknowledged after "
+            + std::to_string(options.max_retries) + " retries");
+    }
+
+    for (packet& unacknowledged : window) {
+        device->write_bytes(unacknowledged.bytes.data(), unacknowledged.bytes.size());
+        unacknowledged.sent = clock::now();
+        ++unacknowledged.retries;
+        ++statistics.retransmissions;
+    }
+}
+
+size_t acknowledged_link::in_flight() const
+{
+    return window.size();
+}
+
+link_statistics acknowledged_link::get_statistics() const
+{
+    link_statistics result = statistics;
+    if (round_trips != 0) {
+        result.mean_round_trip = round_trip_sum / round_trips;
+    }
+    const double elapsed = std::chrono::duration<double>(last_delivery - first_send).count();
+    if (elapsed > 0) {
+        result.delivered_bytes_per_second = result.delivered_bytes / elapsed;
+    }
+    return result;
+}
+
+bool acknowledged_link::is_cancelled() const
+{
+    return cancelled;
+}
+
+#ifdef __unix__
+void acknowledged_link::cancel()
+{
+    cancelled = true;
+    const uint8_t wakeup = 1;
+    (void)!write(cancel_pipe[1], &wakeup, sizeof(wakeup));
+}
+
+bool acknowledged_link::wait_readable(const clock::time_point& deadline) const
+{
+    struct pollfd descriptors[2] = { { device->native_handle(), POLLIN, 0 }, { cancel_pipe[0], POLLIN, 0 } };
+    while (true) {
+        const auto remaining = deadline - clock::now();
+        if (remaining <= clock::duration::zero()) {
+            return false;
+        }
+
+#ifdef __linux__
+        const auto remaining_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+        const struct timespec timeout = { static_cast<time_t>(remaining_ns / 1000000000),
+            static_cast<long>(remaining_ns % 1000000000) };
+        const int poll_result = ppoll(descriptors, 2, &timeout, nullptr);
+#else
+        // Round up so that waiting never ends just before deadline
+        const auto timeout = std::chrono::ceil<std::chrono::milliseconds>(remaining).count();
+        const int poll_result = poll(descriptors, 2, static_cast<int>(std::min<decltype(timeout)>(timeout, 60000)));
+#endif
+        if (poll_result == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Error waiting for device: " + std::to_string(errno));
+        }
+        if (descriptors[1].revents != 0) {
+            return false;
+        }
+        if (descriptors[0].revents != 0) {
+            return true;
+        }
+    }
+}
+
+#elif defined (_WIN32) || defined(_WIN64)
+void acknowledged_link::cancel()
+{
+    cancelled = true;
+}
+
+bool acknowledged_link::wait_readable(const clock::time_point& deadline) const
+{
+    // Same millisecond granularity as comm timeouts used for reading
+    if (cancelled || (clock::now() >= deadline)) {
+        return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return true;
+}
+
+#endif
+
+link_receiver::link_receiver()
+    : expected_size(link_packet::header_size), expected_sequence(0), nak_sent(false), last_rejected(0), reply()
+{ }
+
+link_receiver::status link_receiver::feed(const uint8_t byte, const clock::time_point& arrival)
+{
+    const bool timed_out = !buffer.empty() && (arrival - last_arrival > packet_timeout);
+    last_arrival = arrival;
+    if (timed_out) {
+        buffer.clear();
+        expected_size = link_packet::header_size;
+    }
+
+    if ((buffer.size() < sizeof(link_packet::magic)) && (byte != link_packet::magic[buffer.size()])) {
+        buffer.clear();
+        if (byte == link_packet::magic[0]) {
+            buffer.push_back(byte);
+        }
+        return status::incomplete;
+    }
+
+    buffer.push_back(byte);
+    if (buffer.size() == link_packet::header_size) {
+        // Damaged size would swallow following packets, so it is checked before waiting for payload
+        if ((buffer[3] == 0) || (buffer[4] != static_cast<uint8_t>(~buffer[3]))) {
+            buffer.clear();
+            return answer(status::corrupted);
+        }
+        expected_size = link_packet::header_size + buffer[3] + link_packet::checksum_size;
+    }
+    if (buffer.size() < expected_size) {
+        return status::incomplete;
+    }
+
+    const size_t checked_size = buffer.size() - link_packet::checksum_size - sizeof(link_packet::magic);
+    uint32_t checksum = 0;
+    for (size_t byte_no = 0; byte_no < link_packet::checksum_size; ++byte_no) {
+        checksum |= static_cast<uint32_t>(buffer[checked_size + sizeof(link_packet::magic) + byte_no]) << (8 * byte_no);
+    }
+    const bool intact = crc32(buffer.data() + sizeof(link_packet::magic), checked_size) == checksum;
+    const uint8_t sequence = buffer[2];
+    status result;
+    if (!intact) {
+        // Sequence of a damaged packet is only a hint, good enough to tell a new pass of the sender
+        note_rejected(sequence);
+        result = status::corrupted;
+    } else if (sequence == expected_sequence) {
+        payload.assign(buffer.begin() + link_packet::header_size, buffer.end() - link_packet::checksum_size);
+        result = status::delivered;
+    } else if (sequence_distance(sequence, expected_sequence) <= 128) {
+        result = status::duplicate;
+    } else {
+        note_rejected(sequence);
+        result = status::out_of_order;
+    }
+
+    buffer.clear();
+    expected_size = link_packet::header_size;
+    return answer(result);
+}
+
+void link_receiver::note_rejected(const uint8_t sequence)
+{
+    // Sequence going back means sender started the window over, and the gap deserves another NAK
+    if (sequence_distance(expected_sequence, sequence) <= sequence_distance(expected_sequence, last_rejected)) {
+        nak_sent = false;
+    }
+    last_rejected = sequence;
+}
+
+link_receiver::status link_receiver::answer(const status result)
+{
+    if (result == status::delivered) {
+        reply = { link_packet::ack, expected_sequence++ };
+        nak_sent = false;
+    } else if ((result != status::duplicate) && !nak_sent) {
+        reply = { link_packet::nak, expected_sequence };
+        nak_sent = true;
+    } else {
+        reply = { link_packet::ack, static_cast<uint8_t>(expected_sequence - 1) };
+    }
+    return result;
+}
+
+const std::vector<uint8_t>& link_receiver::get_payload() const
+{
+    return payload;
+}
+
+std::array<uint8_t, link_packet::reply_size> link_receiver::get_reply() const
+{
+    return reply;
+}
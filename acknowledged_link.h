@@ -0,0 +1,157 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_ACKNOWLEDGED_LINK_H
+#define DDS_FPGA_TICKER_CLIENT_ACKNOWLEDGED_LINK_H
+
+
+#include <array>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "serial_device.h"
+
+namespace fpga_ticker_client {
+    /*
+     * Packets of acknowledged mode, numbers little-endian:
+     *
+     *   offset  size  field
+     *   0       2     magic 0xA5 0x5C
+     *   2       1     sequence number
+     *   3       1     payload size N, 1..255
+     *   4       1     bitwise complement of N
+     *   5       N     7-segment symbols
+     *   5 + N   4     CRC-32 of bytes from sequence number to the last symbol
+     *
+     * Board replies with two bytes: ACK (0x06) and sequence of the last packet received in order, acknowledging
+     * it and all before it, or NAK (0x15) and sequence it expected when a packet arrived damaged.
+     */
+    struct link_packet {
+        static constexpr uint8_t magic[2] = { 0xA5, 0x5C };
+        static constexpr uint8_t ack = 0x06, nak = 0x15;
+        static constexpr size_t header_size = 5, checksum_size = 4, reply_size = 2;
+        static constexpr size_t max_payload = 255;
+
+        static std::vector<uint8_t> serialize(const uint8_t sequence, const uint8_t* payload, const size_t count);
+    };
+
+    struct link_options {
+        // Packets in flight, at most 127 so that sequence numbers stay unambiguous
+        size_t window = 8;
+        std::chrono::milliseconds timeout = std::chrono::milliseconds(200);
+        // Retransmissions of one packet before link is considered lost
+        size_t max_retries = 10;
+    };
+
+    struct link_statistics {
+        uint64_t packets = 0;
+        uint64_t retransmissions = 0;
+        uint64_t naks = 0;
+        uint64_t timeouts = 0;
+        uint64_t delivered_bytes = 0;
+        double delivered_bytes_per_second = 0;
+        std::chrono::nanoseconds mean_round_trip = std::chrono::nanoseconds::zero();
+
+        std::string to_string() const;
+    };
+
+    /*
+     * Go-back-N sender: keeps up to window packets unacknowledged, so throughput is bound by window size rather
+     * than by round trips. Damaged or lost packets are sent again together with everything after them.
+     * Only cancel() may be called from other threads.
+     */
+    class acknowledged_link {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        explicit acknowledged_link(const std::shared_ptr<serial_device>& device,
+            const link_options& options = link_options());
+        ~acknowledged_link();
+        acknowledged_link(const acknowledged_link&) = delete;
+        acknowledged_link& operator=(const acknowledged_link&) = delete;
+
+        // Sends payload as one packet, false when window is full or link is cancelled
+        bool try_send(const uint8_t* payload, const size_t count);
+        // Same, waiting for room in window; false only when cancelled
+        bool send(const uint8_t* payload, const size_t count);
+        // Handles replies and retransmissions until deadline passes or window empties, false when cancelled
+        bool process_until(const clock::time_point& deadline);
+        // Waits until every packet was acknowledged or link is cancelled
+        bool flush();
+
+        size_t in_flight() const;
+        link_statistics get_statistics() const;
+        void cancel();
+        bool is_cancelled() const;
+
+    private:
+        struct packet {
+            uint8_t sequence;
+            size_t payload_size;
+            size_t retries;
+            std::vector<uint8_t> bytes;
+            clock::time_point sent;
+        };
+
+        bool process(const clock::time_point& deadline, const size_t target_in_flight);
+        void read_replies();
+        void handle_reply(const uint8_t type, const uint8_t sequence);
+        void resend_all();
+        void acknowledge_through(const uint8_t sequence);
+        // Waits for reply bytes until deadline, false on timeout or cancellation
+        bool wait_readable(const clock::time_point& deadline) const;
+
+        const std::shared_ptr<serial_device> device;
+        const link_options options;
+        std::deque<packet> window;
+        uint8_t next_sequence;
+        size_t unanswered_retries;
+        std::array<uint8_t, link_packet::reply_size> reply;
+        size_t reply_size;
+        link_statistics statistics;
+        std::chrono::nanoseconds round_trip_sum;
+        uint64_t round_trips;
+        clock::time_point first_send, last_delivery;
+        std::atomic_bool cancelled;
+#ifdef __unix__
+        int cancel_pipe[2];
+#endif
+    };
+
+    /*
+     * Board side of acknowledged mode, fed byte by byte; used by the emulator.
+     */
+    class link_receiver {
+    public:
+        using clock = std::chrono::steady_clock;
+        enum class status { incomplete, delivered, duplicate, out_of_order, corrupted };
+
+        static constexpr clock::duration packet_timeout = std::chrono::milliseconds(100);
+
+        link_receiver();
+
+        status feed(const uint8_t byte, const clock::time_point& arrival);
+        // Payload of packet delivered by last feed
+        const std::vector<uint8_t>& get_payload() const;
+        // Reply to send back whenever feed did not return incomplete
+        std::array<uint8_t, link_packet::reply_size> get_reply() const;
+
+    private:
+        void note_rejected(const uint8_t sequence);
+        status answer(const status result);
+
+        std::vector<uint8_t> buffer, payload;
+        size_t expected_size;
+        uint8_t expected_sequence;
+        // One NAK per pass of the sender over a gap, or packets following a lost one would restart it repeatedly
+        bool nak_sent;
+        uint8_t last_rejected;
+        std::array<uint8_t, link_packet::reply_size> reply;
+        clock::time_point last_arrival;
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_ACKNOWLEDGED_LINK_H
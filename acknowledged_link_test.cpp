@@ -0,0 +1,116 @@
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <future>
+#include <vector>
+#include <cstdlib>
+#include <stdexcept>
+#include "acknowledged_link.h"
+#include "fpga_emulator.h"
+#include "serial_device.h"
+
+using namespace fpga_ticker_client;
+
+namespace {
+    // Longest wait for all packets to be acknowledged, well above a few timeouts
+    const std::chrono::seconds flush_timeout(5);
+    const size_t packets = 3, payload_size = 20;
+    // First payload byte of the first packet
+    const size_t damaged_byte = link_packet::header_size;
+
+    /*
+     * Board that damages one byte of the first packet, so it is rejected and resent after a NAK, and drops its
+     * first acknowledgement of the last packet, so it is resent after a timeout.
+     */
+    struct lossy_board {
+        link_receiver receiver;
+        std::vector<uint8_t> delivered;
+        size_t received_bytes = 0;
+        bool reply_dropped = false;
+
+        void feed(fpga_emulator& emulator, uint8_t byte, const fpga_emulator::clock::time_point& arrival)
+        {
+            if (received_bytes++ == damaged_byte) {
+                byte ^= 0x10;
+            }
+            const link_receiver::status status = receiver.feed(byte, arrival);
+            if (status == link_receiver::status::incomplete) {
+                return;
+            }
+            if (status == link_receiver::status::delivered) {
+                delivered.insert(delivered.end(), receiver.get_payload().begin(), receiver.get_payload().end());
+                if (!reply_dropped && (delivered.size() == packets * payload_size)) {
+                    reply_dropped = true;
+                    return;
+                }
+            }
+            const auto reply = receiver.get_reply();
+            emulator.reply(reply.data(), reply.size());
+        }
+    };
+}
+
+int main()
+{
+    fpga_emulator emulator;
+    lossy_board board;
+    std::thread receiving_thread([&emulator, &board] {
+        emulator.run([&emulator, &board](const uint8_t byte, const fpga_emulator::clock::time_point& arrival) {
+            board.feed(emulator, byte, arrival);
+        });
+    });
+
+    int result = EXIT_SUCCESS;
+    std::vector<uint8_t> sent;
+    link_statistics statistics;
+    try {
+        const auto device = std::make_shared<serial_device>(emulator.get_device_path(), 115200);
+        if (!device->is_opened()) {
+            throw std::runtime_error("Error opening " + emulator.get_device_path());
+        }
+
+        link_options options;
+        options.timeout = std::chrono::milliseconds(100);
+        acknowledged_link link(device, options);
+        for (size_t packet_no = 0; packet_no < packets; ++packet_no) {
+            std::vector<uint8_t> payload(payload_size);
+            for (size_t byte_no = 0; byte_no < payload_size; ++byte_no) {
+                payload[byte_no] = static_cast<uint8_t>(packet_no * payload_size + byte_no);
+            }
+            link.send(payload.data(), payload.size());
+            sent.insert(sent.end(), payload.begin(), payload.end());
+        }
+
+        auto flushed = std::async(std::launch::async, [&link] { return link.flush(); });
+        if (flushed.wait_for(flush_timeout) != std::future_status::ready) {
+            link.cancel();
+            flushed.wait();
+            throw std::runtime_error("Packets were not acknowledged in time");
+        }
+        if (!flushed.get() || (link.in_flight() != 0)) {
+            throw std::runtime_error("Link gave up on packets");
+        }
+        statistics = link.get_statistics();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        result = EXIT_FAILURE;
+    }
+
+    emulator.stop();
+    receiving_thread.join();
+    if (result != EXIT_SUCCESS) {
+        return result;
+    }
+
+    if (board.delivered != sent) {
+        std::cerr << "Board got " << board.delivered.size() << " bytes other than the " << sent.size() << " sent"
+            << std::endl;
+        return EXIT_FAILURE;
+    }
+    if ((statistics.naks == 0) || (statistics.timeouts == 0) || (statistics.retransmissions < 2)) {
+        std::cerr << "Damaged and unacknowledged packets were not resent: " << statistics.to_string() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,220 @@
+#include "async_serial_writer.h"
+#include <stdexcept>
+#include <algorithm>
+#include <thread>
+
+using namespace fpga_ticker_client;
+
+#ifdef __unix__
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+async_serial_writer::async_serial_writer(const std::shared_ptr<serial_device>& device, const size_t capacity,
+    sender_metrics* metrics)
+    : device(device), metrics(metrics), buffer(capacity), buffer_head(0), buffer_size(0), batches(capacity), batches_head(0),
+    batches_size(0), submitted_batch(0), completed_batch(0), cancelled(false)
+{
+    if (capacity == 0) {
+        throw std::invalid_argument("Writer capacity must be positive");
+    }
+
+#ifdef __unix__
+    if (pipe(cancel_pipe) == -1) {
+        throw std::runtime_error("Error creating cancellation pipe: " + std::to_string(errno));
+    }
+    for (const int descriptor : cancel_pipe) {
+        fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL) | O_NONBLOCK);
+        fcntl(descriptor, F_SETFD, FD_CLOEXEC);
+    }
+#endif
+
+    device->set_non_blocking(true);
+}
+
+async_serial_writer::~async_serial_writer()
+{
+    try {
+        device->set_non_blocking(false);
+    } catch (const std::exception&) { }
+#ifdef __unix__
+    close(cancel_pipe[0]);
+    close(cancel_pipe[1]);
+#endif
+}
+
+uint64_t async_serial_writer::submit(const uint8_t* bytes, const size_t count)
+{
+    if (cancelled || (count == 0) || (count > buffer.size() - buffer_size)) {
+        return 0;
+    }
+
+    const size_t tail = (buffer_head + buffer_size) % buffer.size();
+    const size_t first_part = std::min(count, buffer.size() - tail);
+    std::copy(bytes, bytes + first_part, buffer.begin() + tail);
+    std::copy(bytes + first_part, bytes + count, buffer.begin());
+    buffer_size += count;
+
+    batches[(batches_head + batches_size) % batches.size()] = { ++submitted_batch, count };
+    ++batches_size;
+
+    write_queued();
+    return submitted_batch;
+}
+
+bool async_serial_writer::process()
+{
+    if (cancelled) {
+        drop_queued();
+        return false;
+    }
+    return write_queued();
+}
+
+bool async_serial_writer::process_until(const clock::time_point& deadline)
+{
+    while (true) {
+        if (cancelled) {
+            drop_queued();
+            return false;
+        }
+        if (write_queued()) {
+            return true;
+        }
+        if (!wait_writable(deadline)) {
+            if (cancelled) {
+                drop_queued();
+            }
+            return buffer_size == 0;
+        }
+    }
+}
+
+bool async_serial_writer::write_queued()
+{
+    while (buffer_size != 0) {
+        const size_t contiguous = std::min(buffer_size, buffer.size() - buffer_head);
+        const clock::time_point write_start = clock::now();
+        const size_t written = device->write_available(buffer.data() + buffer_head, contiguous);
+        if (metrics) {
+            metrics->record_write_latency(clock::now() - write_start);
+            metrics->add_bytes_sent(written);
+        }
+        buffer_head = (buffer_head + written) % buffer.size();
+        buffer_size -= written;
+
+        size_t acknowledged = written;
+        while (acknowledged != 0) {
+            pending_batch& batch = batches[batches_head];
+            const size_t batch_part = std::min(acknowledged, batch.remaining);
+            batch.remaining -= batch_part;
+            acknowledged -= batch_part;
+            if (batch.remaining == 0) {
+                completed_batch = batch.id;
+                batches_head = (batches_head + 1) % batches.size();
+                --batches_size;
+            }
+        }
+
+        if (written < contiguous) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void async_serial_writer::drop_queued()
+{
+    buffer_head = 0;
+    buffer_size = 0;
+    batches_head = 0;
+    batches_size = 0;
+}
+
+size_t async_serial_writer::queue_depth() const
+{
+    return buffer_size;
+}
+
+size_t async_serial_writer::capacity() const
+{
+    return buffer.size();
+}
+
+uint64_t async_serial_writer::last_submitted_batch() const
+{
+    return submitted_batch;
+}
+
+uint64_t async_serial_writer::last_completed_batch() const
+{
+    return completed_batch;
+}
+
+bool async_serial_writer::is_cancelled() const
+{
+    return cancelled;
+}
+
+#ifdef __unix__
+void async_serial_writer::cancel()
+{
+    cancelled = true;
+    const uint8_t wakeup = 1;
+    (void)!write(cancel_pipe[1], &wakeup, sizeof(wakeup));
+}
+
+bool async_serial_writer::wait_writable(const clock::time_point& deadline) const
+{
+    struct pollfd descriptors[2] = { { device->native_handle(), POLLOUT, 0 }, { cancel_pipe[0], POLLIN, 0 } };
+    while (true) {
+        const auto remaining = deadline - clock::now();
+        if (remaining <= clock::duration::zero()) {
+            return false;
+        }
+
+#ifdef __linux__
+        const auto remaining_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+        const struct timespec timeout = { static_cast<time_t>(remaining_ns / 1000000000),
+            static_cast<long>(remaining_ns % 1000000000) };
+        const int poll_result = ppoll(descriptors, 2, &timeout, nullptr);
+#else
+        // Round up so that waiting never ends just before deadline
+        const auto timeout = std::chrono::ceil<std::chrono::milliseconds>(remaining).count();
+        const int poll_result = poll(descriptors, 2, static_cast<int>(std::min<decltype(timeout)>(timeout, 60000)));
+#endif
+        if (poll_result == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Error waiting for device: " + std::to_string(errno));
+        }
+        if (descriptors[1].revents != 0) {
+            return false;
+        }
+        if (descriptors[0].revents != 0) {
+            return true;
+        }
+    }
+}
+
+#elif defined (_WIN32) || defined(_WIN64)
+void async_serial_writer::cancel()
+{
+    cancelled = true;
+}
+
+bool async_serial_writer::wait_writable(const clock::time_point& deadline) const
+{
+    // Comm writes already time out after a millisecond, so retry at that granularity
+    if (cancelled || (clock::now() >= deadline)) {
+        return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return true;
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_ASYNC_SERIAL_WRITER_H
+#define DDS_FPGA_TICKER_CLIENT_ASYNC_SERIAL_WRITER_H
+
+
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "serial_device.h"
+#include "sender_metrics.h"
+
+namespace fpga_ticker_client {
+    /*
+     * Queues byte batches for a device switched to non-blocking mode and writes them while the owner waits for
+     * its next deadline. Batches complete in submission order, so progress is reported as the id of the last
+     * completed batch. Only cancel() may be called from other threads.
+     */
+    class async_serial_writer {
+    public:
+        using clock = std::chrono::steady_clock;
+        static constexpr size_t default_capacity = 4096;
+
+        explicit async_serial_writer(const std::shared_ptr<serial_device>& device,
+            const size_t capacity = default_capacity, sender_metrics* metrics = nullptr);
+        ~async_serial_writer();
+        async_serial_writer(const async_serial_writer&) = delete;
+        async_serial_writer& operator=(const async_serial_writer&) = delete;
+
+        // Queues copy of bytes and starts writing them, returns batch id or 0 when queue has no room
+        uint64_t submit(const uint8_t* bytes, const size_t count);
+        // Writes queued bytes until queue is empty, deadline passes or writer is cancelled; true if queue is empty
+        bool process_until(const clock::time_point& deadline);
+        // Writes what device takes right now without waiting for it; true if queue is empty
+        bool process();
+
+        size_t queue_depth() const;
+        size_t capacity() const;
+        uint64_t last_submitted_batch() const;
+        uint64_t last_completed_batch() const;
+
+        // Drops queued batches and wakes process_until; further submissions are rejected
+        void cancel();
+        bool is_cancelled() const;
+
+    private:
+        struct pending_batch {
+            uint64_t id;
+            size_t remaining;
+        };
+
+        bool write_queued();
+        bool wait_writable(const clock::time_point& deadline) const;
+        void drop_queued();
+
+        const std::shared_ptr<serial_device> device;
+        sender_metrics* const metrics;
+        std::vector<uint8_t> buffer;
+        size_t buffer_head, buffer_size;
+        std::vector<pending_batch> batches;
+        size_t batches_head, batches_size;
+        uint64_t submitted_batch, completed_batch;
+        std::atomic_bool cancelled;
+#ifdef __unix__
+        int cancel_pipe[2];
+#endif
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_ASYNC_SERIAL_WRITER_H
@@ -0,0 +1,94 @@
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include "async_serial_writer.h"
+#include "serial_device.h"
+
+using namespace fpga_ticker_client;
+
+namespace {
+    // Nothing reads the master side, so the slave stops taking bytes once the pty buffer is full
+    int open_stalled_pty(std::string& slave_path)
+    {
+        const int master = posix_openpt(O_RDWR | O_NOCTTY);
+        if ((master == -1) || (grantpt(master) == -1) || (unlockpt(master) == -1)) {
+            return -1;
+        }
+        slave_path = ptsname(master);
+        return master;
+    }
+}
+
+int main()
+{
+    std::string slave_path;
+    const int master = open_stalled_pty(slave_path);
+    if (master == -1) {
+        std::cerr << "Error opening pseudo-terminal" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const auto device = std::make_shared<serial_device>(slave_path, 115200);
+    if (!device->is_opened()) {
+        std::cerr << "Error opening " << slave_path << std::endl;
+        close(master);
+        return EXIT_FAILURE;
+    }
+
+    async_serial_writer writer(device);
+    const std::vector<uint8_t> chunk(256, 0x55);
+    // Kernel keeps moving slave output to master input for a while after the first refused write, so the device
+    // only counts as stalled once it took nothing for a quiet period
+    auto quiet_since = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - quiet_since < std::chrono::milliseconds(100)) {
+        if (device->write_available(chunk.data(), chunk.size()) != 0) {
+            quiet_since = std::chrono::steady_clock::now();
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    if (writer.submit(chunk.data(), chunk.size()) == 0) {
+        std::cerr << "Error queueing bytes" << std::endl;
+        close(master);
+        return EXIT_FAILURE;
+    }
+
+    // Cancelling is what ended a blocked process() before, so it is only a fallback that makes the check fail
+    std::mutex done_mx;
+    std::condition_variable done_cv;
+    bool done = false;
+    std::thread watchdog([&] {
+        std::unique_lock<std::mutex> lock(done_mx);
+        if (!done_cv.wait_for(lock, std::chrono::seconds(2), [&done] { return done; })) {
+            writer.cancel();
+        }
+    });
+    const auto start = std::chrono::steady_clock::now();
+    const bool drained = writer.process();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    {
+        std::lock_guard<std::mutex> lock(done_mx);
+        done = true;
+    }
+    done_cv.notify_all();
+    watchdog.join();
+    close(master);
+
+    if (drained) {
+        std::cerr << "Stalled device took queued bytes" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (elapsed > std::chrono::milliseconds(100)) {
+        std::cerr << "process() waited for stalled device for "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() << " ms" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,441 @@
+#include "byte_trace.h"
+#include <stdexcept>
+#include <sstream>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#ifdef __unix__
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#elif defined (_WIN32) || defined(_WIN64)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#endif
+
+using namespace fpga_ticker_client;
+
+namespace {
+    // Header field offsets
+    const size_t capacity_offset = 8;
+    const size_t head_offset = 16;
+    const size_t tail_offset = 24;
+    const size_t overwritten_offset = 32;
+    const size_t device_count_offset = 40;
+    const size_t devices_offset = 48;
+
+    static_assert(devices_offset + byte_trace_format::max_devices * byte_trace_format::device_path_size
+        <= byte_trace_format::header_size, "Device table does not fit trace header");
+
+    template<typename T>
+    T load(const uint8_t* from)
+    {
+        T value;
+        std::memcpy(&value, from, sizeof(value));
+        return value;
+    }
+
+    template<typename T>
+    void store(uint8_t* to, const T value)
+    {
+        std::memcpy(to, &value, sizeof(value));
+    }
+
+    std::chrono::nanoseconds interval_mean(const std::chrono::nanoseconds& sum, const uint64_t count)
+    {
+        return (count == 0) ? std::chrono::nanoseconds::zero()
+            : std::chrono::nanoseconds(sum.count() / static_cast<int64_t>(count));
+    }
+}
+
+std::string trace_statistics::to_string() const
+{
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    std::ostringstream stream;
+    stream << device
+        << ": records: " << records
+        << ", bytes: " << bytes
+        << ", duration: " << duration_cast<std::chrono::milliseconds>(duration).count() << " ms"
+        << ", interval mean/min/max: " << duration_cast<microseconds>(mean_interval).count()
+        << "/" << duration_cast<microseconds>(min_interval).count()
+        << "/" << duration_cast<microseconds>(max_interval).count() << " us"
+        << ", jitter: " << duration_cast<microseconds>(interval_jitter).count() << " us";
+    return stream.str();
+}
+
+#ifdef __unix__
+byte_trace_recorder::byte_trace_recorder(const std::string& path, const size_t capacity)
+    : mapping(nullptr), ring(nullptr), capacity(capacity)
+{
+    if (capacity < min_capacity) {
+        throw std::invalid_argument("Trace must hold at least " + std::to_string(min_capacity) + " bytes");
+    }
+
+    const int file = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (file == -1) {
+        throw std::runtime_error("Error creating " + path + ": " + std::to_string(errno));
+    }
+    const size_t size = byte_trace_format::header_size + capacity;
+    if (ftruncate(file, static_cast<off_t>(size)) == -1) {
+        const int error = errno;
+        close(file);
+        throw std::runtime_error("Error resizing " + path + ": " + std::to_string(error));
+    }
+
+    void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    const int error = errno;
+    close(file);
+    if (view == MAP_FAILED) {
+        throw std::runtime_error("Error mapping " + path + ": " + std::to_string(error));
+    }
+    mapping = static_cast<uint8_t*>(view);
+    ring = mapping + byte_trace_format::header_size;
+
+    std::memcpy(mapping, byte_trace_format::magic, sizeof(byte_trace_format::magic));
+    store<uint64_t>(mapping + capacity_offset, capacity);
+}
+
+byte_trace_recorder::~byte_trace_recorder()
+{
+    munmap(mapping, byte_trace_format::header_size + capacity);
+}
+
+#elif defined (_WIN32) || defined(_WIN64)
+byte_trace_recorder::byte_trace_recorder(const std::string& path, const size_t capacity)
+    : mapping(nullptr), ring(nullptr), capacity(capacity)
+{
+    if (capacity < min_capacity) {
+        throw std::invalid_argument("Trace must hold at least " + std::to_string(min_capacity) + " bytes");
+    }
+
+    const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Error creating " + path + ": " + std::to_string(GetLastError()));
+    }
+
+    const auto size = static_cast<uint64_t>(byte_trace_format::header_size + capacity);
+    const HANDLE file_mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, static_cast<DWORD>(size >> 32),
+        static_cast<DWORD>(size), NULL);
+    void* view = (file_mapping != NULL) ? MapViewOfFile(file_mapping, FILE_MAP_WRITE, 0, 0, 0) : nullptr;
+    const DWORD error = GetLastError();
+    // View keeps the mapping alive on its own
+    if (file_mapping != NULL) {
+        CloseHandle(file_mapping);
+    }
+    CloseHandle(file);
+    if (view == nullptr) {
+        throw std::runtime_error("Error mapping " + path + ": " + std::to_string(error));
+    }
+    mapping = static_cast<uint8_t*>(view);
+    ring = mapping + byte_trace_format::header_size;
+
+    std::memcpy(mapping, byte_trace_format::magic, sizeof(byte_trace_format::magic));
+    store<uint64_t>(mapping + capacity_offset, capacity);
+}
+
+byte_trace_recorder::~byte_trace_recorder()
+{
+    UnmapViewOfFile(mapping);
+}
+
+#endif
+
+uint16_t byte_trace_recorder::register_device(const std::string& device_path)
+{
+    const std::string name = device_path.substr(0, byte_trace_format::device_path_size - 1);
+
+    std::lock_guard<std::mutex> lock(record_mx);
+    const auto device_count = load<uint32_t>(mapping + device_count_offset);
+    for (uint32_t device = 0; device < device_count; ++device) {
+        const auto slot = reinterpret_cast<const char*>(mapping + devices_offset
+            + device * byte_trace_format::device_path_size);
+        if (name == slot) {
+            return static_cast<uint16_t>(device);
+        }
+    }
+    if (device_count == byte_trace_format::max_devices) {
+        throw std::length_error("Trace already holds " + std::to_string(byte_trace_format::max_devices)
+            + " devices");
+    }
+
+    std::memcpy(mapping + devices_offset + device_count * byte_trace_format::device_path_size, name.c_str(),
+        name.size() + 1);
+    store<uint32_t>(mapping + device_count_offset, device_count + 1);
+    return static_cast<uint16_t>(device_count);
+}
+
+void byte_trace_recorder::record(const uint16_t device, const uint8_t* bytes, size_t count)
+{
+    const auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch());
+
+    std::lock_guard<std::mutex> lock(record_mx);
+    while (count > 0) {
+        const size_t record_bytes = std::min(count, byte_trace_format::max_record_bytes);
+        append(timestamp, device, bytes, record_bytes);
+        bytes += record_bytes;
+        count -= record_bytes;
+    }
+}
+
+uint64_t byte_trace_recorder::get_overwritten_records() const
+{
+    return load<uint64_t>(mapping + overwritten_offset);
+}
+
+void byte_trace_recorder::append(const std::chrono::nanoseconds& timestamp, const uint16_t device,
+    const uint8_t* bytes, const size_t count)
+{
+    const size_t record_size = byte_trace_format::record_header_size + count;
+    auto tail = load<uint64_t>(mapping + tail_offset);
+
+    const size_t till_end = capacity - static_cast<size_t>(tail % capacity);
+    if (till_end < record_size) {
+        make_room(till_end);
+        if (till_end >= byte_trace_format::record_header_size) {
+            store<uint16_t>(ring + (tail % capacity) + 8, byte_trace_format::gap_device);
+        }
+        tail += till_end;
+        store<uint64_t>(mapping + tail_offset, tail);
+    }
+
+    make_room(record_size);
+    uint8_t* const to = ring + (tail % capacity);
+    store<uint64_t>(to, static_cast<uint64_t>(timestamp.count()));
+    store<uint16_t>(to + 8, device);
+    store<uint16_t>(to + 10, static_cast<uint16_t>(count));
+    std::memcpy(to + byte_trace_format::record_header_size, bytes, count);
+    // Tail moves only after the record is complete, so a reader never sees a torn one
+    store<uint64_t>(mapping + tail_offset, tail + record_size);
+}
+
+void byte_trace_recorder::make_room(const size_t count)
+{
+    const auto tail = load<uint64_t>(mapping + tail_offset);
+    while (tail + count - load<uint64_t>(mapping + head_offset) > capacity) {
+        drop_oldest();
+    }
+}
+
+void byte_trace_recorder::drop_oldest()
+{
+    const auto head = load<uint64_t>(mapping + head_offset);
+    const size_t position = static_cast<size_t>(head % capacity);
+    const size_t till_end = capacity - position;
+
+    size_t record_size = till_end;
+    if ((till_end >= byte_trace_format::record_header_size)
+        && (load<uint16_t>(ring + position + 8) != byte_trace_format::gap_device)) {
+        record_size = byte_trace_format::record_header_size + load<uint16_t>(ring + position + 10);
+        store<uint64_t>(mapping + overwritten_offset, load<uint64_t>(mapping + overwritten_offset) + 1);
+    }
+    store<uint64_t>(mapping + head_offset, head + record_size);
+}
+
+#ifdef __unix__
+byte_trace_reader::byte_trace_reader(const std::string& path) : mapping(nullptr), size(0), overwritten_records(0)
+{
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file == -1) {
+        throw std::runtime_error("Error opening " + path + ": " + std::to_string(errno));
+    }
+
+    struct stat file_status = {};
+    if (fstat(file, &file_status) == -1) {
+        const int error = errno;
+        close(file);
+        throw std::runtime_error("Error reading size of " + path + ": " + std::to_string(error));
+    }
+    size = static_cast<size_t>(file_status.st_size);
+    if (size < byte_trace_format::header_size) {
+        close(file);
+        throw std::runtime_error(path + " is not a byte trace");
+    }
+
+    void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    const int error = errno;
+    close(file);
+    if (view == MAP_FAILED) {
+        throw std::runtime_error("Error mapping " + path + ": " + std::to_string(error));
+    }
+    mapping = static_cast<const uint8_t*>(view);
+    try {
+        parse();
+    } catch (const std::exception& e) {
+        munmap(const_cast<uint8_t*>(mapping), size);
+        throw std::runtime_error(path + ": " + e.what());
+    }
+}
+
+byte_trace_reader::~byte_trace_reader()
+{
+    munmap(const_cast<uint8_t*>(mapping), size);
+}
+
+#elif defined (_WIN32) || defined(_WIN64)
+byte_trace_reader::byte_trace_reader(const std::string& path) : mapping(nullptr), size(0), overwritten_records(0)
+{
+    const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+        OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Error opening " + path + ": " + std::to_string(GetLastError()));
+    }
+
+    LARGE_INTEGER file_size;
+    if (GetFileSizeEx(file, &file_size) == FALSE) {
+        const DWORD error = GetLastError();
+        CloseHandle(file);
+        throw std::runtime_error("Error reading size of " + path + ": " + std::to_string(error));
+    }
+    size = static_cast<size_t>(file_size.QuadPart);
+    if (size < byte_trace_format::header_size) {
+        CloseHandle(file);
+        throw std::runtime_error(path + " is not a byte trace");
+    }
+
+    const HANDLE file_mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    const void* view = (file_mapping != NULL) ? MapViewOfFile(file_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    const DWORD error = GetLastError();
+    if (file_mapping != NULL) {
+        CloseHandle(file_mapping);
+    }
+    CloseHandle(file);
+    if (view == nullptr) {
+        throw std::runtime_error("Error mapping " + path + ": " + std::to_string(error));
+    }
+    mapping = static_cast<const uint8_t*>(view);
+    try {
+        parse();
+    } catch (const std::exception& e) {
+        UnmapViewOfFile(mapping);
+        throw std::runtime_error(path + ": " + e.what());
+    }
+}
+
+byte_trace_reader::~byte_trace_reader()
+{
+    UnmapViewOfFile(mapping);
+}
+
+#endif
+
+const std::vector<std::string>& byte_trace_reader::get_devices() const
+{
+    return devices;
+}
+
+const std::vector<byte_trace_record>& byte_trace_reader::get_records() const
+{
+    return records;
+}
+
+uint64_t byte_trace_reader::get_overwritten_records() const
+{
+    return overwritten_records;
+}
+
+std::vector<trace_statistics> byte_trace_reader::get_statistics() const
+{
+    std::vector<trace_statistics> statistics(devices.size());
+    std::vector<std::chrono::nanoseconds> previous(devices.size(), std::chrono::nanoseconds::min());
+    std::vector<std::chrono::nanoseconds> first(devices.size());
+    std::vector<std::chrono::nanoseconds> interval_sum(devices.size(), std::chrono::nanoseconds::zero());
+    std::vector<double> interval_square_sum(devices.size(), 0);
+
+    for (size_t device = 0; device < devices.size(); ++device) {
+        statistics[device].device = devices[device];
+    }
+    for (const auto& record : records) {
+        auto& device_statistics = statistics[record.device];
+        ++device_statistics.records;
+        device_statistics.bytes += record.count;
+
+        if (previous[record.device] == std::chrono::nanoseconds::min()) {
+            first[record.device] = record.timestamp;
+        } else {
+            const auto interval = record.timestamp - previous[record.device];
+            if ((device_statistics.records == 2) || (interval < device_statistics.min_interval)) {
+                device_statistics.min_interval = interval;
+            }
+            device_statistics.max_interval = std::max(device_statistics.max_interval, interval);
+            interval_sum[record.device] += interval;
+            interval_square_sum[record.device] += static_cast<double>(interval.count())
+                * static_cast<double>(interval.count());
+        }
+        previous[record.device] = record.timestamp;
+        device_statistics.duration = record.timestamp - first[record.device];
+    }
+
+    for (size_t device = 0; device < devices.size(); ++device) {
+        auto& device_statistics = statistics[device];
+        if (device_statistics.records < 2) {
+            continue;
+        }
+        const uint64_t intervals = device_statistics.records - 1;
+        device_statistics.mean_interval = interval_mean(interval_sum[device], intervals);
+        const double mean = static_cast<double>(device_statistics.mean_interval.count());
+        const double variance = interval_square_sum[device] / static_cast<double>(intervals) - mean * mean;
+        device_statistics.interval_jitter = std::chrono::nanoseconds(
+            static_cast<int64_t>(std::sqrt(std::max(variance, 0.0))));
+    }
+    return statistics;
+}
+
+void byte_trace_reader::parse()
+{
+    if (std::memcmp(mapping, byte_trace_format::magic, sizeof(byte_trace_format::magic)) != 0) {
+        throw std::runtime_error("not a byte trace");
+    }
+    const auto capacity = load<uint64_t>(mapping + capacity_offset);
+    if ((capacity == 0) || (capacity > size - byte_trace_format::header_size)) {
+        throw std::runtime_error("trace is truncated");
+    }
+
+    const auto device_count = load<uint32_t>(mapping + device_count_offset);
+    if (device_count > byte_trace_format::max_devices) {
+        throw std::runtime_error("trace device table is corrupted");
+    }
+    for (uint32_t device = 0; device < device_count; ++device) {
+        const auto slot = reinterpret_cast<const char*>(mapping + devices_offset
+            + device * byte_trace_format::device_path_size);
+        devices.emplace_back(slot, strnlen(slot, byte_trace_format::device_path_size));
+    }
+    overwritten_records = load<uint64_t>(mapping + overwritten_offset);
+
+    const uint8_t* ring = mapping + byte_trace_format::header_size;
+    auto head = load<uint64_t>(mapping + head_offset);
+    const auto tail = load<uint64_t>(mapping + tail_offset);
+    if ((head > tail) || (tail - head > capacity)) {
+        throw std::runtime_error("trace ring offsets are corrupted");
+    }
+
+    while (head < tail) {
+        const auto position = static_cast<size_t>(head % capacity);
+        const size_t till_end = static_cast<size_t>(capacity) - position;
+        if ((till_end < byte_trace_format::record_header_size)
+            || (load<uint16_t>(ring + position + 8) == byte_trace_format::gap_device)) {
+            head += till_end;
+            continue;
+        }
+
+        byte_trace_record record;
+        record.timestamp = std::chrono::nanoseconds(static_cast<int64_t>(load<uint64_t>(ring + position)));
+        record.device = load<uint16_t>(ring + position + 8);
+        record.count = load<uint16_t>(ring + position + 10);
+        record.bytes = ring + position + byte_trace_format::record_header_size;
+        const size_t record_size = byte_trace_format::record_header_size + record.count;
+        if ((record.device >= devices.size()) || (record_size > till_end) || (head + record_size > tail)) {
+            throw std::runtime_error("trace record at " + std::to_string(head) + " is corrupted");
+        }
+        records.push_back(record);
+        head += record_size;
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_BYTE_TRACE_H
+#define DDS_FPGA_TICKER_CLIENT_BYTE_TRACE_H
+
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+
+namespace fpga_ticker_client {
+    /*
+     * Trace file is a fixed-size memory-mapped ring, so recording is a copy into memory with no system calls and
+     * the oldest writes are overwritten once it is full. Layout, in host byte order:
+     *
+     *   header    magic "TKTRACE1", ring capacity, logical offsets of oldest record and of the end of newest one,
+     *             overwritten record count, device count and table of device paths
+     *   ring      records: u64 steady clock nanoseconds, u16 device index, u16 byte count N, N bytes written.
+     *             Record never crosses ring end, the rest of ring is skipped instead; device index 0xFFFF marks
+     *             such a gap when it is long enough to hold a record header.
+     */
+    struct byte_trace_format {
+        static constexpr char magic[8] = { 'T', 'K', 'T', 'R', 'A', 'C', 'E', '1' };
+        static constexpr size_t max_devices = 32;
+        static constexpr size_t device_path_size = 120;
+        static constexpr size_t header_size = 4096;
+        static constexpr size_t record_header_size = 12;
+        static constexpr uint16_t gap_device = 0xFFFF;
+        static constexpr size_t max_record_bytes = 0xFFFF;
+    };
+
+    struct byte_trace_record {
+        std::chrono::nanoseconds timestamp;
+        uint16_t device;
+        const uint8_t* bytes;
+        uint16_t count;
+    };
+
+    // Intervals between consecutive writes to one device
+    struct trace_statistics {
+        std::string device;
+        uint64_t records = 0;
+        uint64_t bytes = 0;
+        std::chrono::nanoseconds duration = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds mean_interval = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds min_interval = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds max_interval = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds interval_jitter = std::chrono::nanoseconds::zero();
+
+        std::string to_string() const;
+    };
+
+    class byte_trace_recorder {
+    public:
+        static constexpr size_t default_capacity = 64 << 20;
+        static constexpr size_t min_capacity = 256 << 10;
+
+        byte_trace_recorder(const std::string& path, const size_t capacity = default_capacity);
+        ~byte_trace_recorder();
+        byte_trace_recorder(const byte_trace_recorder&) = delete;
+        byte_trace_recorder& operator=(const byte_trace_recorder&) = delete;
+
+        // Returns index of device path in trace, registering it on first use
+        uint16_t register_device(const std::string& device_path);
+        // Safe to call from any thread
+        void record(const uint16_t device, const uint8_t* bytes, size_t count);
+        uint64_t get_overwritten_records() const;
+
+    private:
+        void append(const std::chrono::nanoseconds& timestamp, const uint16_t device, const uint8_t* bytes,
+            const size_t count);
+        void drop_oldest();
+        void make_room(const size_t count);
+
+        uint8_t* mapping;
+        uint8_t* ring;
+        size_t capacity;
+        std::mutex record_mx;
+    };
+
+    class byte_trace_reader {
+    public:
+        explicit byte_trace_reader(const std::string& path);
+        ~byte_trace_reader();
+        byte_trace_reader(const byte_trace_reader&) = delete;
+        byte_trace_reader& operator=(const byte_trace_reader&) = delete;
+
+        const std::vector<std::string>& get_devices() const;
+        // Records from oldest to newest, bytes point into the mapped file and live as long as reader
+        const std::vector<byte_trace_record>& get_records() const;
+        uint64_t get_overwritten_records() const;
+        std::vector<trace_statistics> get_statistics() const;
+
+    private:
+        void parse();
+
+        const uint8_t* mapping;
+        size_t size;
+        std::vector<std::string> devices;
+        std::vector<byte_trace_record> records;
+        uint64_t overwritten_records;
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_BYTE_TRACE_H
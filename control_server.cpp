@@ -0,0 +1,305 @@
+#include "control_server.h"
+#include <sstream>
+#include <iterator>
+#include <stdexcept>
+
+using namespace fpga_ticker_client;
+
+namespace {
+    size_t parse_id(const std::string& value)
+    {
+        size_t parsed_length = 0;
+        unsigned long number = 0;
+        try {
+            number = std::stoul(value, &parsed_length, 10);
+        } catch (const std::exception&) {
+            parsed_length = 0;
+        }
+        if ((parsed_length == 0) || (parsed_length != value.size())) {
+            throw std::invalid_argument("invalid number " + value);
+        }
+        return number;
+    }
+
+    // Parses one command into updates, "list", "begin", "commit" and "abort" are handled by caller
+    std::vector<fanout_update> parse_command(const std::string& line)
+    {
+        std::istringstream stream(line);
+        std::string command, id;
+        stream >> command;
+        if ((command != "start") && (command != "stop") && (command != "text") && (command != "period")) {
+            throw std::invalid_argument("unknown command " + command);
+        }
+        if (!(stream >> id)) {
+            throw std::invalid_argument("missing ticker id");
+        }
+
+        std::vector<fanout_update> updates;
+        if ((command == "start") || (command == "stop")) {
+            do {
+                fanout_update update;
+                update.ticker_id = parse_id(id);
+                update.paused = command == "stop";
+                updates.push_back(update);
+            } while (stream >> id);
+        } else if (command == "text") {
+            fanout_update update;
+            update.ticker_id = parse_id(id);
+            stream.get();
+            update.text = std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+            updates.push_back(update);
+        } else {
+            std::string period;
+            if (!(stream >> period)) {
+                throw std::invalid_argument("missing period");
+            }
+            fanout_update update;
+            update.ticker_id = parse_id(id);
+            update.period = std::chrono::milliseconds(parse_id(period));
+            updates.push_back(update);
+        }
+        return updates;
+    }
+}
+
+std::string control_server::handle(session& client, const std::string& line)
+{
+    const std::string command = line.substr(0, line.find(' '));
+    if (command == "list") {
+        return list();
+    }
+    if (command == "begin") {
+        if (client.in_batch) {
+            return "error batch already begun";
+        }
+        client.in_batch = true;
+        client.batch.clear();
+        client.batch_error.clear();
+        return "";
+    }
+    if ((command == "commit") || (command == "abort")) {
+        if (!client.in_batch) {
+            return "error no batch begun";
+        }
+        client.in_batch = false;
+        std::vector<fanout_update> batch;
+        batch.swap(client.batch);
+        if (command == "abort") {
+            return "ok";
+        }
+        if (!client.batch_error.empty()) {
+            return "error " + client.batch_error;
+        }
+        try {
+            fanout.apply(batch);
+        } catch (const std::exception& e) {
+            return std::string("error ") + e.what();
+        }
+        return "ok " + std::to_string(batch.size());
+    }
+
+    try {
+        std::vector<fanout_update> updates = parse_command(line);
+        if (client.in_batch) {
+            client.batch.insert(client.batch.end(), updates.begin(), updates.end());
+            return "";
+        }
+        fanout.apply(updates);
+        return "ok";
+    } catch (const std::exception& e) {
+        if (client.in_batch) {
+            // Only the first error is reported, on commit
+            if (client.batch_error.empty()) {
+                client.batch_error = e.what() + std::string(" in: ") + line;
+            }
+            return "";
+        }
+        return std::string("error ") + e.what();
+    }
+}
+
+std::string control_server::list() const
+{
+    const std::vector<fanout_ticker_status> tickers = fanout.get_status();
+    std::ostringstream reply;
+    reply << "ok " << tickers.size();
+    for (const fanout_ticker_status& ticker : tickers) {
+        reply << '\n' << ticker.id << ' ' << (ticker.failed ? "failed" : (ticker.paused ? "stopped" : "running"))
+            << ' ' << std::chrono::duration_cast<std::chrono::milliseconds>(ticker.period).count()
+            << ' ' << ticker.bytes_sent << ' ' << ticker.device_path << ' ' << ticker.text;
+    }
+    return reply.str();
+}
+
+#ifdef __unix__
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+control_server::control_server(const std::string& path, ticker_fanout& fanout)
+    : path(path), fanout(fanout), listening_socket(-1), stop_pipe{ -1, -1 }, running(false)
+{
+    struct sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Control socket path is too long: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    // Socket left by a previous run that did not exit cleanly is replaced, any other file is never removed
+    struct stat existing = {};
+    if (lstat(path.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            throw std::runtime_error("Control socket path exists and is not a socket: " + path);
+        }
+        unlink(path.c_str());
+    }
+
+    listening_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listening_socket == -1) {
+        throw std::runtime_error("Error creating control socket: " + std::to_string(errno));
+    }
+    fcntl(listening_socket, F_SETFD, FD_CLOEXEC);
+    if ((bind(listening_socket, reinterpret_cast<const struct sockaddr*>(&address), sizeof(address)) == -1)
+        || (listen(listening_socket, 16) == -1) || (pipe(stop_pipe) == -1)) {
+        const int error = errno;
+        close(listening_socket);
+        throw std::runtime_error("Error listening on " + path + ": " + std::to_string(error));
+    }
+    for (const int descriptor : stop_pipe) {
+        fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL) | O_NONBLOCK);
+        fcntl(descriptor, F_SETFD, FD_CLOEXEC);
+    }
+}
+
+control_server::~control_server()
+{
+    close(listening_socket);
+    close(stop_pipe[0]);
+    close(stop_pipe[1]);
+    unlink(path.c_str());
+}
+
+void control_server::run()
+{
+    std::vector<session> clients;
+    std::vector<struct pollfd> descriptors;
+    running = true;
+    while (running) {
+        descriptors.clear();
+        descriptors.push_back({ stop_pipe[0], POLLIN, 0 });
+        descriptors.push_back({ listening_socket, POLLIN, 0 });
+        for (const session& client : clients) {
+            descriptors.push_back({ client.socket, POLLIN, 0 });
+        }
+
+        if (poll(descriptors.data(), descriptors.size(), -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Error waiting for control requests: " + std::to_string(errno));
+        }
+        if (descriptors[0].revents != 0) {
+            break;
+        }
+
+        // Clients are served before new ones are accepted, so descriptors still match their sessions
+        for (size_t client_no = clients.size(); client_no-- > 0; ) {
+            if ((descriptors[client_no + 2].revents != 0) && !serve(clients[client_no])) {
+                close(clients[client_no].socket);
+                clients.erase(clients.begin() + static_cast<std::ptrdiff_t>(client_no));
+            }
+        }
+        if (descriptors[1].revents != 0) {
+            const int client_socket = accept(listening_socket, nullptr, nullptr);
+            if (client_socket != -1) {
+                fcntl(client_socket, F_SETFL, fcntl(client_socket, F_GETFL) | O_NONBLOCK);
+                fcntl(client_socket, F_SETFD, FD_CLOEXEC);
+                clients.push_back({ client_socket, std::string(), false, { }, std::string() });
+            }
+        }
+    }
+
+    for (const session& client : clients) {
+        close(client.socket);
+    }
+}
+
+void control_server::stop()
+{
+    running = false;
+    const uint8_t wakeup = 1;
+    (void)!write(stop_pipe[1], &wakeup, sizeof(wakeup));
+}
+
+bool control_server::serve(session& client)
+{
+    char buffer[4096];
+    const ssize_t read_count = recv(client.socket, buffer, sizeof(buffer), 0);
+    if (read_count == 0) {
+        return false;
+    }
+    if (read_count == -1) {
+        return (errno == EINTR) || (errno == EAGAIN) || (errno == EWOULDBLOCK);
+    }
+    client.input.append(buffer, static_cast<size_t>(read_count));
+
+    std::string replies;
+    size_t line_end;
+    while ((line_end = client.input.find('\n')) != std::string::npos) {
+        std::string line = client.input.substr(0, line_end);
+        client.input.erase(0, line_end + 1);
+        if (!line.empty() && (line.back() == '\r')) {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+        const std::string reply = handle(client, line);
+        if (!reply.empty()) {
+            replies += reply + '\n';
+        }
+    }
+    if (client.input.size() > max_line) {
+        replies += "error request line is too long\n";
+    }
+
+    // Replies are small, a client that does not read them is dropped rather than waited for
+    size_t sent = 0;
+    while (sent < replies.size()) {
+        const ssize_t send_result = send(client.socket, replies.data() + sent, replies.size() - sent, MSG_NOSIGNAL);
+        if (send_result > 0) {
+            sent += static_cast<size_t>(send_result);
+        } else if ((send_result == -1) && (errno != EINTR)) {
+            return false;
+        }
+    }
+    return client.input.size() <= max_line;
+}
+
+#else
+control_server::control_server(const std::string& path, ticker_fanout& fanout)
+    : path(path), fanout(fanout), listening_socket(-1), stop_pipe{ -1, -1 }, running(false)
+{
+    throw std::runtime_error("Control server needs Unix domain sockets and is only supported on Unix");
+}
+
+control_server::~control_server() = default;
+
+void control_server::run()
+{ }
+
+void control_server::stop()
+{ }
+
+bool control_server::serve(session&)
+{
+    return false;
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_CONTROL_SERVER_H
+#define DDS_FPGA_TICKER_CLIENT_CONTROL_SERVER_H
+
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include "ticker_fanout.h"
+
+namespace fpga_ticker_client {
+    /*
+     * Local control of fan-out tickers over a Unix domain socket. Requests are text lines, every reply starts
+     * with "ok" or "error REASON":
+     *
+     *   list                  ok N, then line "ID STATE PERIOD_MS BYTES_SENT DEVICE TEXT" per ticker
+     *   start ID...           resume tickers
+     *   stop ID...            pause tickers, last character stays shown
+     *   text ID TEXT          replace text
+     *   period ID MS          change period
+     *   begin                 collect following commands, no reply until
+     *   commit                applies them as one batch, ok N or error with nothing applied
+     *   abort                 drops collected commands
+     *
+     * Commands outside begin and commit are batches of one. Changes take effect at each ticker's next tick.
+     */
+    class control_server {
+    public:
+        static constexpr size_t max_line = 64 * 1024;
+
+        control_server(const std::string& path, ticker_fanout& fanout);
+        ~control_server();
+        control_server(const control_server&) = delete;
+        control_server& operator=(const control_server&) = delete;
+
+        // Serves clients until stopped
+        void run();
+        void stop();
+
+    private:
+        struct session {
+            int socket;
+            std::string input;
+            bool in_batch;
+            std::vector<fanout_update> batch;
+            std::string batch_error;
+        };
+
+        // Reply to request line, empty while collecting a batch
+        std::string handle(session& client, const std::string& line);
+        std::string list() const;
+        bool serve(session& client);
+
+        const std::string path;
+        ticker_fanout& fanout;
+        int listening_socket;
+        int stop_pipe[2];
+        std::atomic_bool running;
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_CONTROL_SERVER_H
@@ -0,0 +1,185 @@
+#include "device_watcher.h"
+#include <chrono>
+#include <stdexcept>
+
+using namespace fpga_ticker_client;
+
+namespace {
+    const std::chrono::milliseconds retry_interval(500);
+}
+
+bool device_watcher::reopen(serial_device& device)
+{
+    while (!cancelled) {
+        // Armed before the attempt, so device appearing right after it failed still wakes the wait up
+        watch_parent();
+        if (device.reopen()) {
+            return true;
+        }
+        wait_change();
+    }
+    return false;
+}
+
+bool device_watcher::is_cancelled() const
+{
+    return cancelled;
+}
+
+#ifdef __unix__
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const uint32_t watched_events = IN_CREATE | IN_MOVED_TO | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF
+        | IN_ONLYDIR;
+}
+
+device_watcher::device_watcher(const std::string& path)
+    : path(path), notify(-1), watch(-1), cancel_pipe{ -1, -1 }, cancelled(false)
+{
+    if (path.empty()) {
+        throw std::invalid_argument("Device path to watch is empty");
+    }
+    notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (notify == -1) {
+        throw std::runtime_error("Error creating inotify instance: " + std::to_string(errno));
+    }
+    if (pipe(cancel_pipe) == -1) {
+        const int error = errno;
+        close(notify);
+        throw std::runtime_error("Error creating cancellation pipe: " + std::to_string(error));
+    }
+    for (const int descriptor : cancel_pipe) {
+        fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL) | O_NONBLOCK);
+        fcntl(descriptor, F_SETFD, FD_CLOEXEC);
+    }
+}
+
+device_watcher::~device_watcher()
+{
+    close(notify);
+    close(cancel_pipe[0]);
+    close(cancel_pipe[1]);
+}
+
+void device_watcher::cancel()
+{
+    cancelled = true;
+    const uint8_t wakeup = 1;
+    (void)!write(cancel_pipe[1], &wakeup, sizeof(wakeup));
+}
+
+void device_watcher::watch_parent()
+{
+    // Relative path is resolved against working directory, root always exists
+    std::string directory = path, entry;
+    struct stat directory_stat = {};
+    do {
+        const size_t separator = directory.find_last_of('/');
+        if (separator == std::string::npos) {
+            entry = directory;
+            directory = ".";
+        } else {
+            entry = directory.substr(separator + 1);
+            directory = (separator == 0) ? "/" : directory.substr(0, separator);
+        }
+    } while ((stat(directory.c_str(), &directory_stat) == -1) && (directory != "/") && (directory != "."));
+
+    if ((watch != -1) && (directory == watched_directory)) {
+        watched_entry = entry;
+        return;
+    }
+    if (watch != -1) {
+        inotify_rm_watch(notify, watch);
+    }
+    // Watch that cannot be added leaves waiting to the retry interval
+    watch = inotify_add_watch(notify, directory.c_str(), watched_events);
+    watched_directory = directory;
+    watched_entry = entry;
+}
+
+void device_watcher::wait_change()
+{
+    const auto retry_deadline = std::chrono::steady_clock::now() + retry_interval;
+    while (!cancelled) {
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(retry_deadline
+            - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0) {
+            return;
+        }
+
+        struct pollfd descriptors[] = { { cancel_pipe[0], POLLIN, 0 }, { notify, POLLIN, 0 } };
+        if (poll(descriptors, 2, static_cast<int>(remaining.count())) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Error waiting for device " + path + ": " + std::to_string(errno));
+        }
+        if (descriptors[0].revents != 0) {
+            return;
+        }
+        if (descriptors[1].revents == 0) {
+            continue;
+        }
+
+        // Other entries of busy directories such as /dev or /tmp are read and ignored
+        alignas(struct inotify_event) char buffer[16 * (sizeof(struct inotify_event) + NAME_MAX + 1)];
+        bool changed = false;
+        ssize_t read_count;
+        while ((read_count = read(notify, buffer, sizeof(buffer))) > 0) {
+            for (ssize_t offset = 0; offset < read_count; ) {
+                const auto event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(struct inotify_event) + event->len);
+                if ((event->wd != watch) || ((event->len != 0) && (watched_entry != event->name))) {
+                    continue;
+                }
+                changed = true;
+                // Watched directory itself went away, the next one up is watched on the next attempt
+                if ((event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) != 0) {
+                    watch = -1;
+                }
+            }
+        }
+        if (changed) {
+            return;
+        }
+    }
+}
+
+#else
+device_watcher::device_watcher(const std::string& path)
+    : path(path), notify(-1), watch(-1), cancel_pipe{ -1, -1 }, cancelled(false)
+{
+    if (path.empty()) {
+        throw std::invalid_argument("Device path to watch is empty");
+    }
+}
+
+device_watcher::~device_watcher() = default;
+
+void device_watcher::cancel()
+{
+    {
+        std::lock_guard<std::mutex> lock(cancel_mx);
+        cancelled = true;
+    }
+    cancel_cv.notify_all();
+}
+
+void device_watcher::watch_parent()
+{ }
+
+void device_watcher::wait_change()
+{
+    // No change notifications here, every attempt waits out the retry interval
+    std::unique_lock<std::mutex> lock(cancel_mx);
+    cancel_cv.wait_for(lock, retry_interval, [this] { return cancelled.load(); });
+}
+
+#endif
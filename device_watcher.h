@@ -0,0 +1,48 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_DEVICE_WATCHER_H
+#define DDS_FPGA_TICKER_CLIENT_DEVICE_WATCHER_H
+
+
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include "serial_device.h"
+
+namespace fpga_ticker_client {
+    /*
+     * Waits for device path such as /dev/ttyUSB0 or /dev/serial/by-id/... link to come back after adapter was
+     * unplugged. On Linux it sleeps on inotify events of the closest existing directory on the path, so device is
+     * opened again as soon as udev creates its node or link, even if the by-id directory itself went away; other
+     * platforms poll. Attempts are also retried every half a second for changes no event is raised for, such as
+     * node a link points to appearing after the link. cancel() may be called from any thread.
+     */
+    class device_watcher {
+    public:
+        explicit device_watcher(const std::string& path);
+        ~device_watcher();
+        device_watcher(const device_watcher&) = delete;
+        device_watcher& operator=(const device_watcher&) = delete;
+
+        // Reopens device with its own settings once path is back, false if cancelled first
+        bool reopen(serial_device& device);
+        void cancel();
+        bool is_cancelled() const;
+
+    private:
+        // Watches closest existing directory on the path, remembering which entry of it leads to device
+        void watch_parent();
+        // Returns when watched entry changed, retry interval passed or watcher was cancelled
+        void wait_change();
+
+        const std::string path;
+        int notify, watch;
+        int cancel_pipe[2];
+        std::string watched_directory, watched_entry;
+        std::atomic_bool cancelled;
+        std::mutex cancel_mx;
+        std::condition_variable cancel_cv;
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_DEVICE_WATCHER_H
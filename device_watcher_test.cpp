@@ -0,0 +1,124 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <future>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include "device_watcher.h"
+#include "serial_device.h"
+
+using namespace fpga_ticker_client;
+
+namespace {
+    // Longest wait for reopen() before the check fails, well above the retry interval
+    const std::chrono::seconds reopen_timeout(3);
+
+    int open_pty(std::string& slave_path)
+    {
+        const int master = posix_openpt(O_RDWR | O_NOCTTY);
+        if ((master == -1) || (grantpt(master) == -1) || (unlockpt(master) == -1)) {
+            return -1;
+        }
+        slave_path = ptsname(master);
+        return master;
+    }
+
+    // Link is replaced the way udev replaces /dev/serial/by-id links of adapter plugged in again
+    int check_reconnect(const std::string& slave_path, const std::string& link_path)
+    {
+        serial_device device(link_path, 115200);
+        if (!device.is_opened()) {
+            std::cerr << "Error opening " << link_path << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        unlink(link_path.c_str());
+        if (device.reopen()) {
+            std::cerr << "Device was reopened without link" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        device_watcher watcher(link_path);
+        auto reopened = std::async(std::launch::async, [&watcher, &device] { return watcher.reopen(device); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (symlink(slave_path.c_str(), link_path.c_str()) == -1) {
+            std::cerr << "Error creating link " << link_path << std::endl;
+            watcher.cancel();
+            return EXIT_FAILURE;
+        }
+        if (reopened.wait_for(reopen_timeout) != std::future_status::ready) {
+            std::cerr << "Device was not reopened after link came back" << std::endl;
+            watcher.cancel();
+            return EXIT_FAILURE;
+        }
+        if (!reopened.get() || !device.is_opened()) {
+            std::cerr << "Watcher gave up on device that came back" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        const uint8_t symbol = 0x55;
+        try {
+            device.write_bytes(&symbol, sizeof(symbol));
+        } catch (const std::exception& e) {
+            std::cerr << "Error writing to reopened device: " << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    int check_cancel(const std::string& link_path)
+    {
+        serial_device device(link_path, 115200);
+        device_watcher watcher(link_path);
+        auto reopened = std::async(std::launch::async, [&watcher, &device] { return watcher.reopen(device); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        watcher.cancel();
+        if (reopened.wait_for(reopen_timeout) != std::future_status::ready) {
+            std::cerr << "Cancel did not end waiting for device" << std::endl;
+            std::_Exit(EXIT_FAILURE);
+        }
+        if (reopened.get()) {
+            std::cerr << "Missing device was reported reopened" << std::endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const std::string check = (argc > 1) ? argv[1] : "";
+    if ((check != "reconnect") && (check != "cancel")) {
+        std::cerr << "Usage: " << argv[0] << " reconnect|cancel" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    char directory_template[] = "/tmp/device_watcher_test.XXXXXX";
+    if (mkdtemp(directory_template) == nullptr) {
+        std::cerr << "Error creating temporary directory" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const std::string directory = directory_template;
+    const std::string link_path = directory + "/ttyFPGA";
+
+    int result;
+    if (check == "cancel") {
+        result = check_cancel(link_path);
+    } else {
+        std::string slave_path;
+        const int master = open_pty(slave_path);
+        if ((master == -1) || (symlink(slave_path.c_str(), link_path.c_str()) == -1)) {
+            std::cerr << "Error opening pseudo-terminal" << std::endl;
+            rmdir(directory.c_str());
+            return EXIT_FAILURE;
+        }
+        result = check_reconnect(slave_path, link_path);
+        close(master);
+    }
+
+    unlink(link_path.c_str());
+    rmdir(directory.c_str());
+    return result;
+}
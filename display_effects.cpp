@@ -0,0 +1,152 @@
+#include "display_effects.h"
+#include <stdexcept>
+#include <algorithm>
+
+using namespace fpga_ticker_client;
+
+namespace {
+    void validate(const effect_options& options)
+    {
+        if ((options.digits == 0) || (options.digits > effect_options::max_digits)) {
+            throw std::invalid_argument("Display must have 1.." + std::to_string(effect_options::max_digits)
+                + " digits");
+        }
+        if (options.hold_frames == 0) {
+            throw std::invalid_argument("Hold must last at least one frame");
+        }
+    }
+
+    // Appends blink or wipe frames of one page, page holds exactly digits symbols
+    void append_page_frames(const uint8_t* page, const effect_options& options, std::vector<uint8_t>& frames)
+    {
+        const size_t digits = options.digits;
+        const auto append_frame = [&frames, page, digits](const size_t shown_from, const size_t shown_to) {
+            for (size_t digit = 0; digit < digits; ++digit) {
+                const bool shown = (digit >= shown_from) && (digit < shown_to);
+                frames.push_back(shown ? page[digit] : display_frames::blank_symbol);
+            }
+        };
+
+        if (options.effect == display_effect::blink) {
+            for (size_t frame = 0; frame < options.hold_frames; ++frame) {
+                append_frame(0, digits);
+            }
+            for (size_t frame = 0; frame < options.hold_frames; ++frame) {
+                append_frame(0, 0);
+            }
+            return;
+        }
+
+        for (size_t revealed = 1; revealed < digits; ++revealed) {
+            append_frame(0, revealed);
+        }
+        for (size_t frame = 0; frame < options.hold_frames; ++frame) {
+            append_frame(0, digits);
+        }
+        for (size_t cleared = 1; cleared < digits; ++cleared) {
+            append_frame(cleared, digits);
+        }
+        append_frame(0, 0);
+    }
+}
+
+display_effect effect_options::parse_effect(const std::string& name)
+{
+    if (name == "scroll") {
+        return display_effect::scroll;
+    } else if (name == "blink") {
+        return display_effect::blink;
+    } else if (name == "wipe") {
+        return display_effect::wipe;
+    }
+    throw std::invalid_argument("Unknown effect " + name);
+}
+
+display_frames::display_frames(const std::vector<uint8_t>& symbols, const effect_options& options)
+    : frame_digits(options.digits)
+{
+    validate(options);
+    if (symbols.empty()) {
+        throw std::invalid_argument("Text to show is empty");
+    }
+
+    const size_t count = symbols.size();
+    if (options.effect == display_effect::scroll) {
+        // Frame i starts i symbols into the text preceded by a blank display, so text enters from the right
+        const size_t cycle = count + frame_digits;
+        frames.reserve(cycle * frame_digits);
+        for (size_t frame = 0; frame < cycle; ++frame) {
+            for (size_t digit = 0; digit < frame_digits; ++digit) {
+                const size_t position = (count + frame + digit) % cycle;
+                frames.push_back((position < count) ? symbols[position] : blank_symbol);
+            }
+        }
+        return;
+    }
+
+    std::vector<uint8_t> page(frame_digits);
+    for (size_t page_start = 0; page_start < count; page_start += frame_digits) {
+        const size_t page_size = std::min(frame_digits, count - page_start);
+        std::copy_n(symbols.begin() + page_start, page_size, page.begin());
+        std::fill(page.begin() + page_size, page.end(), blank_symbol);
+        append_page_frames(page.data(), options, frames);
+    }
+}
+
+const uint8_t* display_frames::frame(const size_t index) const
+{
+    return frames.data() + (index % size()) * frame_digits;
+}
+
+size_t display_frames::size() const
+{
+    return frames.size() / frame_digits;
+}
+
+size_t display_frames::digits() const
+{
+    return frame_digits;
+}
+
+frame_stream::frame_stream(const symbol_reader& read, const effect_options& options)
+    : read(read), options(options), window_head(0), page_frame(0)
+{
+    validate(options);
+    if (options.effect == display_effect::scroll) {
+        window.assign(2 * options.digits, display_frames::blank_symbol);
+    } else {
+        page.resize(options.digits);
+    }
+}
+
+const uint8_t* frame_stream::next()
+{
+    if (options.effect == display_effect::scroll) {
+        uint8_t symbol;
+        read(&symbol, 1);
+        window[window_head] = symbol;
+        window[window_head + options.digits] = symbol;
+        window_head = (window_head + 1) % options.digits;
+        return window.data() + window_head;
+    }
+
+    if (page_frame * options.digits == page_frames.size()) {
+        read(page.data(), page.size());
+        page_frames.clear();
+        append_page_frames(page.data(), options, page_frames);
+        page_frame = 0;
+    }
+    return page_frames.data() + (page_frame++) * options.digits;
+}
+
+void frame_stream::skip(size_t count)
+{
+    while (count-- > 0) {
+        next();
+    }
+}
+
+size_t frame_stream::digits() const
+{
+    return options.digits;
+}
@@ -0,0 +1,77 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_DISPLAY_EFFECTS_H
+#define DDS_FPGA_TICKER_CLIENT_DISPLAY_EFFECTS_H
+
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+namespace fpga_ticker_client {
+    /*
+     * Frames for multi-digit displays, computed from encoded symbols on the host.
+     * A frame holds one symbol per digit, left to right. Multi-digit boards shift each received symbol in from the
+     * right, so a frame written in one batch rewrites the whole display, and a lost byte spoils at most one frame.
+     *
+     *   scroll  text slides through the display from right to left, separated from its next repetition by a blank
+     *           display
+     *   blink   text is split into pages of display width, each shown and blanked for hold frames
+     *   wipe    each page is revealed digit by digit from the left, held, and cleared the same way
+     */
+    enum class display_effect { scroll, blink, wipe };
+
+    struct effect_options {
+        static constexpr size_t max_digits = 64;
+
+        display_effect effect = display_effect::scroll;
+        size_t digits = 8;
+        // Frames a blinking or wiped page stays in one state
+        size_t hold_frames = 4;
+
+        static display_effect parse_effect(const std::string& name);
+    };
+
+    // Frames of a periodic sequence computed once and kept back to back, looped by frame index
+    class display_frames {
+    public:
+        static constexpr uint8_t blank_symbol = 0xFF;
+
+        display_frames(const std::vector<uint8_t>& symbols, const effect_options& options);
+
+        const uint8_t* frame(const size_t index) const;
+        size_t size() const;
+        size_t digits() const;
+
+    private:
+        size_t frame_digits;
+        std::vector<uint8_t> frames;
+    };
+
+    // Frames of a stream too long to precompute, made one at a time from symbols read as they are needed
+    class frame_stream {
+    public:
+        using symbol_reader = std::function<void(uint8_t* symbols, const size_t count)>;
+
+        frame_stream(const symbol_reader& read, const effect_options& options);
+
+        // Frame stays valid until the next call
+        const uint8_t* next();
+        void skip(size_t count);
+        size_t digits() const;
+
+    private:
+        const symbol_reader read;
+        const effect_options options;
+        // Scroll window is stored twice in a row, so the newest digits symbols are always contiguous
+        std::vector<uint8_t> window;
+        size_t window_head;
+        // Current page and its frames for page effects
+        std::vector<uint8_t> page;
+        std::vector<uint8_t> page_frames;
+        size_t page_frame;
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_DISPLAY_EFFECTS_H
@@ -0,0 +1,212 @@
+#include "file_tail_source.h"
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace fpga_ticker_client;
+
+namespace {
+    bool is_continuation(const std::string& text, const size_t position)
+    {
+        return (position < text.size()) && ((static_cast<unsigned char>(text[position]) & 0xC0) == 0x80);
+    }
+}
+
+const std::string& file_tail_source::get_text() const
+{
+    return text;
+}
+
+size_t file_tail_source::get_last_reencoded() const
+{
+    return last_reencoded.load(std::memory_order_relaxed);
+}
+
+std::string file_tail_source::read_text() const
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) {
+        throw std::runtime_error("Error opening " + path);
+    }
+
+    std::string result((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    while (!result.empty() && ((result.back() == '\n') || (result.back() == '\r'))) {
+        result.pop_back();
+    }
+    std::replace_if(result.begin(), result.end(), [](const char character) {
+        return (character == '\n') || (character == '\r') || (character == '\t');
+    }, ' ');
+    return result;
+}
+
+std::unique_ptr<frame_exchange::frame> file_tail_source::splice(const std::string& next_text)
+{
+    const size_t common = std::min(text.size(), next_text.size());
+    size_t prefix = 0;
+    while ((prefix < common) && (text[prefix] == next_text[prefix])) {
+        ++prefix;
+    }
+    if ((prefix == text.size()) && (prefix == next_text.size())) {
+        return nullptr;
+    }
+    size_t suffix = 0;
+    while ((suffix < common - prefix)
+        && (text[text.size() - 1 - suffix] == next_text[next_text.size() - 1 - suffix])) {
+        ++suffix;
+    }
+    // Edit inside a multibyte character changes the whole character
+    while ((prefix > 0) && (is_continuation(text, prefix) || is_continuation(next_text, prefix))) {
+        --prefix;
+    }
+    while ((suffix > 0) && is_continuation(text, text.size() - suffix)) {
+        --suffix;
+    }
+
+    // Unchanged parts are only measured, their symbols are copied from previous frame
+    const std::string_view previous(text);
+    const size_t prefix_symbols = font->measure(previous.substr(0, prefix)).size;
+    const size_t suffix_symbols = font->measure(previous.substr(text.size() - suffix)).size;
+    const std::string_view changed(next_text.data() + prefix, next_text.size() - prefix - suffix);
+    const encode_status required = font->measure(changed);
+    if (!required.ok()) {
+        size_t length;
+        glyph_font::decode(changed.data(), changed.size(), required.unsupported_position, length);
+        throw std::runtime_error("Symbol " + std::string(changed.substr(required.unsupported_position, length))
+            + " is not supported");
+    }
+    if (prefix_symbols + required.size + suffix_symbols == 0) {
+        throw std::runtime_error("Text to send is empty");
+    }
+
+    auto next_characters = std::make_unique<frame_exchange::frame>(prefix_symbols + required.size + suffix_symbols);
+    std::copy_n(characters.begin(), prefix_symbols, next_characters->begin());
+    font->encode(changed, next_characters->data() + prefix_symbols, required.size);
+    std::copy_n(characters.end() - static_cast<std::ptrdiff_t>(suffix_symbols), suffix_symbols,
+        next_characters->end() - static_cast<std::ptrdiff_t>(suffix_symbols));
+
+    text = next_text;
+    characters = *next_characters;
+    last_reencoded.store(changed.size(), std::memory_order_relaxed);
+    return next_characters;
+}
+
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace {
+    const uint32_t watched_events = IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+}
+
+file_tail_source::file_tail_source(const std::string& path, const std::shared_ptr<const glyph_font>& font)
+    : path(path), font(font), last_reencoded(0), notifier(-1), stop_event(-1)
+{
+    splice(read_text());
+
+    const size_t separator = path.rfind('/');
+    const std::string directory = (separator == std::string::npos) ? "."
+        : ((separator == 0) ? "/" : path.substr(0, separator));
+
+    notifier = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    stop_event = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if ((notifier == -1) || (stop_event == -1)
+        || (inotify_add_watch(notifier, directory.c_str(), watched_events) == -1)) {
+        const int error = errno;
+        for (const int descriptor : { notifier, stop_event }) {
+            if (descriptor != -1) {
+                close(descriptor);
+            }
+        }
+        throw std::runtime_error("Error watching " + directory + ": " + std::to_string(error));
+    }
+}
+
+file_tail_source::~file_tail_source()
+{
+    close(notifier);
+    close(stop_event);
+}
+
+void file_tail_source::run(const frame_handler& on_change, const error_handler& on_error)
+{
+    const size_t separator = path.rfind('/');
+    const std::string name = (separator == std::string::npos) ? path : path.substr(separator + 1);
+    alignas(struct inotify_event) char events[4096];
+    // One write usually raises several events, rejected text is reported once
+    std::string rejected_text;
+
+    struct pollfd descriptors[] = { { notifier, POLLIN, 0 }, { stop_event, POLLIN, 0 } };
+    while (true) {
+        if (poll(descriptors, 2, -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Error waiting for file changes: " + std::to_string(errno));
+        }
+        if (descriptors[1].revents != 0) {
+            break;
+        }
+
+        // Burst of writes is read as one change
+        bool changed = false;
+        ssize_t length;
+        while ((length = read(notifier, events, sizeof(events))) > 0) {
+            for (const char* event_position = events; event_position < events + length; ) {
+                const auto event = reinterpret_cast<const struct inotify_event*>(event_position);
+                if ((event->len != 0) && (name == event->name)) {
+                    changed = true;
+                }
+                event_position += sizeof(struct inotify_event) + event->len;
+            }
+        }
+        if (!changed) {
+            continue;
+        }
+
+        try {
+            const std::string next_text = read_text();
+            // Writer truncated file and did not write yet, next event brings the text
+            if (next_text.empty() || (next_text == rejected_text)) {
+                continue;
+            }
+            try {
+                if (auto next_characters = splice(next_text)) {
+                    on_change(std::move(next_characters));
+                }
+                rejected_text.clear();
+            } catch (const std::exception&) {
+                rejected_text = next_text;
+                throw;
+            }
+        } catch (const std::exception& e) {
+            on_error(e.what());
+        }
+    }
+}
+
+void file_tail_source::stop()
+{
+    const uint64_t increment = 1;
+    (void)!write(stop_event, &increment, sizeof(increment));
+}
+
+#else
+file_tail_source::file_tail_source(const std::string& path, const std::shared_ptr<const glyph_font>& font)
+    : path(path), font(font), last_reencoded(0), notifier(-1), stop_event(-1)
+{
+    throw std::runtime_error("Following files is only supported on Linux");
+}
+
+file_tail_source::~file_tail_source() = default;
+
+void file_tail_source::run(const frame_handler&, const error_handler&)
+{ }
+
+void file_tail_source::stop()
+{ }
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_FILE_TAIL_SOURCE_H
+#define DDS_FPGA_TICKER_CLIENT_FILE_TAIL_SOURCE_H
+
+
+#include <string>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include "frame_exchange.h"
+#include "glyph_font.h"
+
+namespace fpga_ticker_client {
+    /*
+     * Follows text file like tail -f and hands over frames re-encoded from its new contents. Only characters between
+     * unchanged beginning and end are encoded again, the rest is copied from previous frame. Directory is watched
+     * rather than file itself, so files replaced by rename keep being followed.
+     * Line breaks and tabs are shown as spaces, trailing line breaks are dropped.
+     */
+    class file_tail_source {
+    public:
+        using frame_handler = std::function<void(std::unique_ptr<frame_exchange::frame>)>;
+        using error_handler = std::function<void(const std::string&)>;
+
+        explicit file_tail_source(const std::string& path,
+            const std::shared_ptr<const glyph_font>& font = glyph_font::builtin());
+        ~file_tail_source();
+        file_tail_source(const file_tail_source&) = delete;
+        file_tail_source& operator=(const file_tail_source&) = delete;
+
+        // Text as of last change, read it before run
+        const std::string& get_text() const;
+        // Number of characters encoded on last change
+        size_t get_last_reencoded() const;
+
+        // Blocks until stopped; changes that cannot be shown are reported and previous frame stays
+        void run(const frame_handler& on_change, const error_handler& on_error);
+        void stop();
+
+    private:
+        std::string read_text() const;
+        std::unique_ptr<frame_exchange::frame> splice(const std::string& next_text);
+
+        const std::string path;
+        const std::shared_ptr<const glyph_font> font;
+        std::string text;
+        frame_exchange::frame characters;
+        std::atomic<size_t> last_reencoded;
+        int notifier, stop_event;
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_FILE_TAIL_SOURCE_H
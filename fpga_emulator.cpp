@@ -0,0 +1,289 @@
+#include "fpga_emulator.h"
+#include "seven_segment_encoder.h"
+#include <stdexcept>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <sstream>
+
+using namespace fpga_ticker_client;
+
+namespace {
+    std::array<char, 256> generate_decoding_table()
+    {
+        std::array<char, 256> table;
+        table.fill('?');
+        // Digits first so that ambiguous shapes like 0 and o decode the same way every time
+        for (const char character : std::string("0123456789abcdefghijklmnopqrstuvwxyz ")) {
+            const seven_segment_glyph& glyph = seven_segment_encoder::glyph(character);
+            if ((glyph.length == 1) && (table[glyph.symbols[0]] == '?')) {
+                table[glyph.symbols[0]] = character;
+            }
+        }
+        return table;
+    }
+
+    bool is_lit(const uint8_t symbol, const uint8_t segment)
+    {
+        return (symbol & (1u << segment)) == 0;
+    }
+
+    double to_us(const std::chrono::nanoseconds& value)
+    {
+        return std::chrono::duration<double, std::micro>(value).count();
+    }
+}
+
+std::string emulator_statistics::to_string() const
+{
+    std::ostringstream result;
+    result << bytes << " bytes, " << bytes_per_second << " bytes/s, period mean " << to_us(mean_period)
+        << " us, min " << to_us(min_period) << " us, max " << to_us(max_period) << " us, jitter "
+        << to_us(period_jitter) << " us, latency mean " << to_us(mean_latency) << " us, max "
+        << to_us(max_latency) << " us";
+    return result.str();
+}
+
+char fpga_emulator::decode_symbol(const uint8_t symbol)
+{
+    static const std::array<char, 256> decoding_table = generate_decoding_table();
+    return decoding_table[symbol];
+}
+
+std::string fpga_emulator::render_symbol(const uint8_t symbol)
+{
+    /*
+     *      0
+     *     ---
+     *  5 |   | 1
+     *     ---   <- 6
+     *  4 |   | 2
+     *     ---
+     *      3
+     */
+    std::string result;
+    result += ' ';
+    result += is_lit(symbol, 0) ? '_' : ' ';
+    result += " \n";
+    result += is_lit(symbol, 5) ? '|' : ' ';
+    result += is_lit(symbol, 6) ? '_' : ' ';
+    result += is_lit(symbol, 1) ? '|' : ' ';
+    result += '\n';
+    result += is_lit(symbol, 4) ? '|' : ' ';
+    result += is_lit(symbol, 3) ? '_' : ' ';
+    result += is_lit(symbol, 2) ? '|' : ' ';
+    return result;
+}
+
+const std::string& fpga_emulator::get_device_path() const
+{
+    return device_path;
+}
+
+const std::string& fpga_emulator::get_slave_path() const
+{
+    return slave_path;
+}
+
+void fpga_emulator::record(const clock::time_point& arrival)
+{
+    std::lock_guard<std::mutex> lock(statistics_mx);
+    if (received == 0) {
+        first_arrival = arrival;
+    } else {
+        const clock::duration period = arrival - last_arrival;
+        const double period_ns = static_cast<double>(std::chrono::nanoseconds(period).count());
+        period_sum += period_ns;
+        period_square_sum += period_ns * period_ns;
+        if ((received == 1) || (period < min_period)) {
+            min_period = period;
+        }
+        if ((received == 1) || (period > max_period)) {
+            max_period = period;
+        }
+    }
+
+    if (expected_period != clock::duration::zero()) {
+        const clock::duration latency = arrival - (first_arrival + expected_period * received);
+        latency_sum += static_cast<double>(std::chrono::nanoseconds(latency).count());
+        max_latency = std::max(max_latency, latency);
+    }
+
+    last_arrival = arrival;
+    ++received;
+}
+
+void fpga_emulator::reset_statistics()
+{
+    std::lock_guard<std::mutex> lock(statistics_mx);
+    received = 0;
+    period_sum = 0;
+    period_square_sum = 0;
+    latency_sum = 0;
+    min_period = clock::duration::zero();
+    max_period = clock::duration::zero();
+    max_latency = clock::duration::zero();
+}
+
+emulator_statistics fpga_emulator::get_statistics() const
+{
+    std::lock_guard<std::mutex> lock(statistics_mx);
+    emulator_statistics statistics;
+    statistics.bytes = received;
+    if (received > 1) {
+        const double periods = static_cast<double>(received - 1);
+        const double mean = period_sum / periods;
+        const double elapsed_s = std::chrono::duration<double>(last_arrival - first_arrival).count();
+        statistics.bytes_per_second = (elapsed_s > 0) ? periods / elapsed_s : 0;
+        statistics.mean_period = std::chrono::nanoseconds(std::llround(mean));
+        statistics.min_period = min_period;
+        statistics.max_period = max_period;
+        statistics.period_jitter = std::chrono::nanoseconds(
+            std::llround(std::sqrt(std::max(period_square_sum / periods - mean * mean, 0.0))));
+    }
+    if (received != 0) {
+        statistics.mean_latency = std::chrono::nanoseconds(std::llround(latency_sum / received));
+        statistics.max_latency = max_latency;
+    }
+    return statistics;
+}
+
+#ifdef __unix__
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+fpga_emulator::fpga_emulator(const clock::duration& expected_period, const std::string& link_path)
+    : expected_period(expected_period), link_path(link_path), master(-1), slave(-1), stop_pipe{ -1, -1 },
+    running(false)
+{
+    reset_statistics();
+
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    if ((master == -1) || (grantpt(master) == -1) || (unlockpt(master) == -1) || (ptsname(master) == nullptr)) {
+        const int error = errno;
+        if (master != -1) {
+            close(master);
+        }
+        throw std::runtime_error("Error creating pseudo-terminal: " + std::to_string(error));
+    }
+    slave_path = ptsname(master);
+
+    // Keeping slave open prevents master reads failing with EIO while client reopens device
+    slave = open(slave_path.c_str(), O_RDWR | O_NOCTTY);
+    struct termios config = {};
+    if ((slave == -1) || (tcgetattr(slave, &config) == -1) || (pipe(stop_pipe) == -1)) {
+        const int error = errno;
+        close(master);
+        if (slave != -1) {
+            close(slave);
+        }
+        throw std::runtime_error("Error opening pseudo-terminal: " + std::to_string(error));
+    }
+    cfmakeraw(&config);
+    tcsetattr(slave, TCSANOW, &config);
+
+    device_path = slave_path;
+    if (!link_path.empty()) {
+        unlink(link_path.c_str());
+        if (symlink(slave_path.c_str(), link_path.c_str()) == -1) {
+            const int error = errno;
+            close(master);
+            close(slave);
+            close(stop_pipe[0]);
+            close(stop_pipe[1]);
+            throw std::runtime_error("Error creating link " + link_path + ": " + std::to_string(error));
+        }
+        device_path = link_path;
+    }
+}
+
+fpga_emulator::~fpga_emulator()
+{
+    if (!link_path.empty()) {
+        unlink(link_path.c_str());
+    }
+    close(stop_pipe[0]);
+    close(stop_pipe[1]);
+    close(slave);
+    close(master);
+}
+
+void fpga_emulator::run(const byte_handler& handler)
+{
+    running = true;
+    struct pollfd descriptors[2] = { { master, POLLIN, 0 }, { stop_pipe[0], POLLIN, 0 } };
+    uint8_t buffer[256];
+    while (running) {
+        if (poll(descriptors, 2, -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Error waiting for data: " + std::to_string(errno));
+        }
+        if (descriptors[1].revents != 0) {
+            break;
+        }
+
+        const ssize_t read_count = read(master, buffer, sizeof(buffer));
+        // Bytes read together share one timestamp, as they arrived within a single wakeup
+        const clock::time_point arrival = clock::now();
+        if (read_count == -1) {
+            if ((errno == EINTR) || (errno == EAGAIN) || (errno == EIO)) {
+                continue;
+            }
+            throw std::runtime_error("Error reading data: " + std::to_string(errno));
+        }
+
+        for (ssize_t byte_no = 0; byte_no < read_count; ++byte_no) {
+            record(arrival);
+            if (handler) {
+                handler(buffer[byte_no], arrival);
+            }
+        }
+    }
+}
+
+void fpga_emulator::stop()
+{
+    running = false;
+    const uint8_t wakeup = 1;
+    (void)!write(stop_pipe[1], &wakeup, sizeof(wakeup));
+}
+
+void fpga_emulator::reply(const uint8_t* bytes, const size_t count)
+{
+    size_t written = 0;
+    while (written < count) {
+        const ssize_t write_result = write(master, bytes + written, count - written);
+        if (write_result > 0) {
+            written += static_cast<size_t>(write_result);
+        } else if ((write_result == -1) && (errno != EINTR)) {
+            throw std::runtime_error("Error writing reply: " + std::to_string(errno));
+        }
+    }
+}
+
+#else
+fpga_emulator::fpga_emulator(const clock::duration& expected_period, const std::string& link_path)
+    : expected_period(expected_period), link_path(link_path), master(-1), slave(-1), stop_pipe{ -1, -1 },
+    running(false)
+{
+    throw std::runtime_error("FPGA emulator needs pseudo-terminals and is only supported on Unix");
+}
+
+fpga_emulator::~fpga_emulator() = default;
+
+void fpga_emulator::run(const byte_handler&)
+{ }
+
+void fpga_emulator::stop()
+{ }
+
+void fpga_emulator::reply(const uint8_t*, const size_t)
+{ }
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_FPGA_EMULATOR_H
+#define DDS_FPGA_TICKER_CLIENT_FPGA_EMULATOR_H
+
+
+#include <string>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+namespace fpga_ticker_client {
+    struct emulator_statistics {
+        size_t bytes = 0;
+        double bytes_per_second = 0;
+        std::chrono::nanoseconds mean_period = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds min_period = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds max_period = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds period_jitter = std::chrono::nanoseconds::zero();
+        // Arrival relative to ideal schedule started at first byte, only with known expected period
+        std::chrono::nanoseconds mean_latency = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds max_latency = std::chrono::nanoseconds::zero();
+
+        std::string to_string() const;
+    };
+
+    /*
+     * Stands in for the board: creates a pseudo-terminal pair whose slave side can be opened as serial_device
+     * and timestamps every byte arriving on the master side.
+     */
+    class fpga_emulator {
+    public:
+        using clock = std::chrono::steady_clock;
+        using byte_handler = std::function<void(const uint8_t symbol, const clock::time_point& arrival)>;
+
+        explicit fpga_emulator(const clock::duration& expected_period = clock::duration::zero(),
+            const std::string& link_path = "");
+        ~fpga_emulator();
+        fpga_emulator(const fpga_emulator&) = delete;
+        fpga_emulator& operator=(const fpga_emulator&) = delete;
+
+        // Path to open as serial device: link path if one was requested, pseudo-terminal slave otherwise
+        const std::string& get_device_path() const;
+        const std::string& get_slave_path() const;
+
+        // Receives bytes until stop() is called
+        void run(const byte_handler& handler = byte_handler());
+        void stop();
+        // Sends bytes back to the client, as board replies in acknowledged mode
+        void reply(const uint8_t* bytes, const size_t count);
+        void reset_statistics();
+        emulator_statistics get_statistics() const;
+
+        static char decode_symbol(const uint8_t symbol);
+        // Three text lines drawing lit segments
+        static std::string render_symbol(const uint8_t symbol);
+
+    private:
+        void record(const clock::time_point& arrival);
+
+        const clock::duration expected_period;
+        std::string slave_path, link_path, device_path;
+        int master, slave;
+        int stop_pipe[2];
+        std::atomic_bool running;
+
+        mutable std::mutex statistics_mx;
+        size_t received;
+        clock::time_point first_arrival, last_arrival;
+        double period_sum, period_square_sum, latency_sum;
+        clock::duration min_period, max_period, max_latency;
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_FPGA_EMULATOR_H
@@ -1,112 +1,676 @@
 #include "fpga_sender.h"
+#include "upload_protocol.h"
 #include <stdexcept>
-#include <mutex>
-#include <unordered_map>
+#include <algorithm>
 
 using namespace fpga_ticker_client;
 
-fpga_sender::fpga_sender(const std::shared_ptr<serial_device>& fpga_device)
-    : fpga_device(fpga_device), should_send(false)
+namespace {
+    // Longest wait for a stalled device in zero period mode, stop requests interrupt it anyway
+    const std::chrono::milliseconds flush_interval(100);
+}
+
+fpga_sender::fpga_sender(const std::shared_ptr<serial_device>& fpga_device,
+    const std::shared_ptr<const glyph_font>& font)
+    : fpga_device(fpga_device), font(font), stop_requests(0), accepted_stop_requests(0), has_pending_period(false),
+    pending_period(std::chrono::steady_clock::duration::zero()), active_realtime_ticker(nullptr),
+    active_writer(nullptr), active_link(nullptr), progress_sequence(0)
 { }
 
-void fpga_sender::send(const std::string& text, const std::chrono::system_clock::duration& ticker_period)
+void fpga_sender::send(const std::string& text, const std::chrono::steady_clock::duration& ticker_period,
+    const missed_deadline_policy policy)
+{
+    if (!fpga_device->is_opened()) {
+        throw std::logic_error("FPGA device was not opened");
+    }
+
+    std::unique_ptr<frame_exchange::frame> seven_segment_characters = encode_frame(text);
+    interrupted.characters.reset();
+    if (ticker_period != std::chrono::steady_clock::duration::zero()) {
+        send_periodic(std::move(seven_segment_characters), 0, ticker_scheduler::clock::now(), ticker_period, policy);
+        return;
+    }
+
+    async_serial_writer writer(fpga_device, async_serial_writer::default_capacity, &metrics);
+    start_sending(&writer, nullptr);
+    try {
+        while (!stop_requested()) {
+            size_t current_character = 0;
+            take_pending(seven_segment_characters, current_character);
+            metrics.add_loop_iteration();
+            write_cyclic(writer, *seven_segment_characters, 0, seven_segment_characters->size());
+            publish_progress(seven_segment_characters->back(), seven_segment_characters->size() - 1,
+                seven_segment_characters->size());
+        }
+    } catch (...) {
+        finish_sending();
+        throw;
+    }
+    finish_sending();
+}
+
+void fpga_sender::resume()
+{
+    if (!interrupted.characters) {
+        throw std::logic_error("There is no interrupted send to resume");
+    }
+    if (!fpga_device->is_opened()) {
+        throw std::logic_error("FPGA device was not opened");
+    }
+
+    // Ticks go on at the deadlines the interrupted send would have had, the first one after now
+    const ticker_scheduler::clock::time_point now = ticker_scheduler::clock::now();
+    const ticker_scheduler::clock::duration period = interrupted.period;
+    ticker_scheduler::clock::time_point start = interrupted.deadline - period;
+    if (now >= interrupted.deadline) {
+        start = interrupted.deadline + period * ((now - interrupted.deadline) / period);
+    }
+    const size_t character = interrupted.character % interrupted.characters->size();
+    send_periodic(std::move(interrupted.characters), character, start, period, interrupted.policy);
+}
+
+bool fpga_sender::can_resume() const
+{
+    return interrupted.characters != nullptr;
+}
+
+void fpga_sender::discard_interrupted()
+{
+    interrupted.characters.reset();
+}
+
+void fpga_sender::send_periodic(std::unique_ptr<frame_exchange::frame> characters, size_t current_character,
+    const std::chrono::steady_clock::time_point& start, const std::chrono::steady_clock::duration& ticker_period,
+    const missed_deadline_policy policy)
+{
+    ticker_scheduler scheduler(ticker_period, policy, start);
+    async_serial_writer writer(fpga_device, async_serial_writer::default_capacity, &metrics);
+    start_sending(&writer, nullptr);
+
+    try {
+        write_cyclic(writer, *characters, current_character, 1);
+        publish_progress((*characters)[current_character], current_character, characters->size());
+        run_ticks(scheduled_ticks(scheduler, writer), [&](const size_t elapsed_ticks) {
+            current_character = send_ticks(writer, characters, current_character, elapsed_ticks, policy);
+        });
+    } catch (...) {
+        // Kept for resume(), last character handed to writer may not have gone out and is sent again first
+        interrupted.characters = std::move(characters);
+        interrupted.character = current_character;
+        interrupted.deadline = scheduler.next_deadline();
+        interrupted.period = scheduler.get_period();
+        interrupted.policy = policy;
+        finish_sending();
+        throw;
+    }
+    finish_sending();
+}
+
+void fpga_sender::send_file(const std::string& path, const std::chrono::steady_clock::duration& ticker_period,
+    const missed_deadline_policy policy)
 {
     if (!fpga_device->is_opened()) {
         throw std::logic_error("FPGA device was not opened");
     }
+    interrupted.characters.reset();
+
+    mapped_text_source source(path, font);
+    // Symbols are encoded into this buffer just before they are queued, it never grows
+    std::vector<std::uint8_t> symbols(async_serial_writer::default_capacity);
+    async_serial_writer writer(fpga_device, async_serial_writer::default_capacity, &metrics);
+    start_sending(&writer, nullptr);
 
-    const std::vector<std::uint8_t> seven_segment_characters = transform_text(text);
-    size_t current_character = 0;
-    std::mutex send_mx;
-    should_send = true;
-    while (should_send) {
-        fpga_device->write_byte(seven_segment_characters[current_character]);
-        {
-            std::unique_lock<std::mutex> lock(send_mx);
-            send_cv.wait_for(lock, ticker_period);
+    try {
+        if (ticker_period == std::chrono::steady_clock::duration::zero()) {
+            while (!stop_requested()) {
+                source.read(symbols.data(), symbols.size());
+                metrics.add_loop_iteration();
+                write_cyclic(writer, symbols, 0, symbols.size());
+                publish_progress(symbols.back(), source.get_position(), source.get_size());
+            }
+        } else {
+            ticker_scheduler scheduler(ticker_period, policy);
+            source.read(symbols.data(), 1);
+            write_cyclic(writer, symbols, 0, 1);
+            publish_progress(symbols.front(), source.get_position(), source.get_size());
+            run_ticks(scheduled_ticks(scheduler, writer), [&](const size_t elapsed_ticks) {
+                send_file_ticks(writer, source, symbols, elapsed_ticks, policy);
+            });
         }
-        current_character = (current_character + 1) % seven_segment_characters.size();
+    } catch (...) {
+        finish_sending();
+        throw;
     }
+    finish_sending();
 }
 
-std::vector<std::uint8_t> fpga_sender::transform_text(const std::string &text) const
+void fpga_sender::send_frames(const std::string& text, const std::chrono::steady_clock::duration& ticker_period,
+    const effect_options& effect, const missed_deadline_policy policy)
 {
-    /*
-     * Segment encoding
-     *      0
-     *     ---
-     *  5 |   | 1
-     *     ---   <- 6
-     *  4 |   | 2
-     *     ---
-     *      3
-     */
+    if (!fpga_device->is_opened()) {
+        throw std::logic_error("FPGA device was not opened");
+    }
+    interrupted.characters.reset();
 
-    const auto generate_seven_segment_symbol = [](const std::vector<uint8_t>& segments) {
-        uint8_t symbol = 0xFF;
-        for (const uint8_t segment : segments)
-        {
-            symbol &= ~(uint8_t)(1u << segment);
+    std::unique_ptr<frame_exchange::frame> seven_segment_characters = encode_frame(text);
+    display_frames frames(*seven_segment_characters, effect);
+    async_serial_writer writer(fpga_device, async_serial_writer::default_capacity, &metrics);
+    start_sending(&writer, nullptr);
+
+    try {
+        if (ticker_period == std::chrono::steady_clock::duration::zero()) {
+            while (!stop_requested()) {
+                const frame_exchange::frame* previous_characters = seven_segment_characters.get();
+                size_t current_frame = 0;
+                take_pending(seven_segment_characters, current_frame);
+                if (seven_segment_characters.get() != previous_characters) {
+                    frames = display_frames(*seven_segment_characters, effect);
+                }
+                metrics.add_loop_iteration();
+                for (size_t frame_no = 0; frame_no < frames.size(); ++frame_no) {
+                    write_frame(writer, frames.frame(frame_no), frames.digits());
+                }
+                publish_progress(frames.frame(frames.size() - 1)[frames.digits() - 1], frames.size() - 1,
+                    frames.size());
+            }
+        } else {
+            ticker_scheduler scheduler(ticker_period, policy);
+            size_t current_frame = 0;
+            write_frame(writer, frames.frame(current_frame), frames.digits());
+            publish_progress(frames.frame(current_frame)[frames.digits() - 1], current_frame, frames.size());
+            run_ticks(scheduled_ticks(scheduler, writer), [&](const size_t elapsed_ticks) {
+                current_frame = send_frame_ticks(writer, seven_segment_characters, frames, effect, current_frame,
+                    elapsed_ticks, policy);
+            });
         }
-        return symbol;
-    };
-    const std::unordered_map<std::string::value_type, std::vector<uint8_t>> seven_segment_characters = {
-            { 'a', { generate_seven_segment_symbol({ 0, 1, 2, 4, 5, 6 }) } },
-            { 'b', { generate_seven_segment_symbol({ 2, 3, 4, 5, 6 }) } },
-            { 'c', { generate_seven_segment_symbol({ 0, 3, 4, 5 }) } },
-            { 'd', { generate_seven_segment_symbol({ 1, 2, 3, 4, 6 }) } },
-            { 'e', { generate_seven_segment_symbol({ 0, 3, 4, 5, 6 }) } },
-            { 'f', { generate_seven_segment_symbol({ 0, 4, 5, 6 }) } },
-            { 'g', { generate_seven_segment_symbol({ 0, 2, 3, 4, 5 }) } },
-            { 'h', { generate_seven_segment_symbol({ 1, 2, 4, 5, 6 }) } },
-            { 'i', { generate_seven_segment_symbol({ 1, 2 }) } },
-            { 'j', { generate_seven_segment_symbol({ 1, 2, 3 }) } },
-            { 'k', { generate_seven_segment_symbol({ 1, 2, 4, 5, 6 }), generate_seven_segment_symbol({ 0, 3, 4, 5 }) } },
-            { 'l', { generate_seven_segment_symbol({ 3, 4, 5 }) } },
-            { 'm', { generate_seven_segment_symbol({ 0, 1, 2, 4, 5 }), generate_seven_segment_symbol({ 0, 1, 2, 4, 5 }) } },
-            { 'n', { generate_seven_segment_symbol({ 2, 4, 6 }) } },
-            { 'o', { generate_seven_segment_symbol({ 0, 1, 2, 3, 4, 5 }) } },
-            { 'p', { generate_seven_segment_symbol({ 0, 1, 4, 5, 6 }) } },
-            { 'q', { generate_seven_segment_symbol({ 0, 1, 2, 5, 6 }) } },
-            { 'r', { generate_seven_segment_symbol({ 4, 6 }) } },
-            { 's', { generate_seven_segment_symbol({ 0, 2, 3, 5, 6 }) } },
-            { 't', { generate_seven_segment_symbol({ 0, 1, 2 }), generate_seven_segment_symbol({ 0, 4, 5 }) } },
-            { 'u', { generate_seven_segment_symbol({ 1, 2, 3, 4, 5 }) } },
-            { 'v', { generate_seven_segment_symbol({ 1, 2, 3, 4, 5 }) } },
-            { 'w', { generate_seven_segment_symbol({ 1, 2, 3, 4, 5 }), generate_seven_segment_symbol({ 1, 2, 3, 4, 5 }) } },
-            { 'x', { generate_seven_segment_symbol({ 0, 1, 2, 3 }), generate_seven_segment_symbol({ 0, 3, 4, 5 }) } },
-            { 'y', { generate_seven_segment_symbol({ 1, 2, 3, 5, 6 }) } },
-            { 'z', { generate_seven_segment_symbol({ 0, 1, 3, 4, 6 }) } },
-            { '0', { generate_seven_segment_symbol({ 0, 1, 2, 3, 4, 5 }) } },
-            { '1', { generate_seven_segment_symbol({ 1, 2 }) } },
-            { '2', { generate_seven_segment_symbol({ 0, 1, 3, 4, 6 }) } },
-            { '3', { generate_seven_segment_symbol({ 0, 1, 2, 3, 6 }) } },
-            { '4', { generate_seven_segment_symbol({ 1, 2, 5, 6 }) } },
-            { '5', { generate_seven_segment_symbol({ 0, 2, 3, 5, 6 }) } },
-            { '6', { generate_seven_segment_symbol({ 0, 2, 3, 4, 5, 6 }) } },
-            { '7', { generate_seven_segment_symbol({ 0, 1, 2 }) } },
-            { '8', { generate_seven_segment_symbol({ 0, 1, 2, 3, 4, 5, 6 }) } },
-            { '9', { generate_seven_segment_symbol({ 0, 1, 2, 3, 5, 6 }) } },
-            { ' ', { generate_seven_segment_symbol({ }) } }
+    } catch (...) {
+        finish_sending();
+        throw;
+    }
+    finish_sending();
+}
+
+void fpga_sender::send_file_frames(const std::string& path, const std::chrono::steady_clock::duration& ticker_period,
+    const effect_options& effect, const missed_deadline_policy policy)
+{
+    if (!fpga_device->is_opened()) {
+        throw std::logic_error("FPGA device was not opened");
+    }
+    interrupted.characters.reset();
+
+    mapped_text_source source(path, font);
+    frame_stream stream([&source](uint8_t* symbols, const size_t count) {
+        source.read(symbols, count);
+    }, effect);
+    async_serial_writer writer(fpga_device, async_serial_writer::default_capacity, &metrics);
+    start_sending(&writer, nullptr);
+
+    try {
+        if (ticker_period == std::chrono::steady_clock::duration::zero()) {
+            while (!stop_requested()) {
+                const uint8_t* frame = stream.next();
+                metrics.add_loop_iteration();
+                write_frame(writer, frame, stream.digits());
+                publish_progress(frame[stream.digits() - 1], source.get_position(), source.get_size());
+            }
+        } else {
+            ticker_scheduler scheduler(ticker_period, policy);
+            const uint8_t* frame = stream.next();
+            write_frame(writer, frame, stream.digits());
+            publish_progress(frame[stream.digits() - 1], source.get_position(), source.get_size());
+            run_ticks(scheduled_ticks(scheduler, writer), [&](const size_t elapsed_ticks) {
+                send_file_frame_ticks(writer, source, stream, elapsed_ticks, policy);
+            });
+        }
+    } catch (...) {
+        finish_sending();
+        throw;
+    }
+    finish_sending();
+}
+
+void fpga_sender::upload(const std::string& text, const std::chrono::microseconds& period)
+{
+    upload(*encode_frame(text), period);
+}
+
+void fpga_sender::upload(const frame_exchange::frame& characters, const std::chrono::microseconds& period)
+{
+    if (!fpga_device->is_opened()) {
+        throw std::logic_error("FPGA device was not opened");
+    }
+    interrupted.characters.reset();
+
+    upload_frame frame;
+    frame.period = period;
+    frame.symbols = characters;
+    const std::vector<std::uint8_t> bytes = frame.serialize();
+    fpga_device->write_bytes(bytes.data(), bytes.size(), true);
+    metrics.add_bytes_sent(bytes.size());
+    publish_progress(characters.front(), 0, characters.size());
+}
+
+link_statistics fpga_sender::send_acknowledged(const std::string& text,
+    const std::chrono::steady_clock::duration& ticker_period, const link_options& options,
+    const missed_deadline_policy policy)
+{
+    if (!fpga_device->is_opened()) {
+        throw std::logic_error("FPGA device was not opened");
+    }
+    interrupted.characters.reset();
+
+    std::unique_ptr<frame_exchange::frame> seven_segment_characters = encode_frame(text);
+    acknowledged_link link(fpga_device, options);
+    start_sending(nullptr, nullptr, &link);
+
+    try {
+        if (ticker_period == std::chrono::steady_clock::duration::zero()) {
+            while (!stop_requested()) {
+                size_t current_character = 0;
+                take_pending(seven_segment_characters, current_character);
+                metrics.add_loop_iteration();
+                if (!send_acknowledged_cyclic(link, *seven_segment_characters, 0, seven_segment_characters->size(),
+                    true)) {
+                    break;
+                }
+                publish_progress(seven_segment_characters->back(), seven_segment_characters->size() - 1,
+                    seven_segment_characters->size());
+            }
+        } else {
+            ticker_scheduler scheduler(ticker_period, policy);
+            size_t current_character = 0;
+            send_acknowledged_cyclic(link, *seven_segment_characters, current_character, 1, true);
+            publish_progress((*seven_segment_characters)[current_character], current_character,
+                seven_segment_characters->size());
+            run_ticks([this, &link, &scheduler](std::chrono::nanoseconds& lateness) -> size_t {
+                return link.process_until(scheduler.next_deadline()) ? wait_scheduled(scheduler, lateness) : 0;
+            }, [&](const size_t elapsed_ticks) {
+                current_character = send_acknowledged_ticks(link, seven_segment_characters, current_character,
+                    elapsed_ticks, policy);
+            });
+        }
+    } catch (...) {
+        finish_sending();
+        throw;
+    }
+    finish_sending();
+    return link.get_statistics();
+}
+
+jitter_statistics fpga_sender::send_realtime(const std::string& text, const realtime_options& options,
+    const missed_deadline_policy policy)
+{
+    if (!fpga_device->is_opened()) {
+        throw std::logic_error("FPGA device was not opened");
+    }
+    interrupted.characters.reset();
+
+    std::unique_ptr<frame_exchange::frame> seven_segment_characters = encode_frame(text);
+
+    realtime_ticker ticker(options);
+    ticker.apply_thread_settings();
+    async_serial_writer writer(fpga_device, async_serial_writer::default_capacity, &metrics);
+    start_sending(&writer, &ticker);
+
+    try {
+        size_t current_character = 0;
+        ticker.start();
+        write_cyclic(writer, *seven_segment_characters, current_character, 1);
+        publish_progress((*seven_segment_characters)[current_character], current_character,
+            seven_segment_characters->size());
+        run_ticks([&ticker](std::chrono::nanoseconds& lateness) {
+            const size_t elapsed_ticks = ticker.wait();
+            lateness = ticker.get_last_lateness();
+            return elapsed_ticks;
+        }, [&](const size_t elapsed_ticks) {
+            current_character = send_ticks(writer, seven_segment_characters, current_character, elapsed_ticks,
+                policy);
+        });
+    } catch (...) {
+        finish_sending();
+        throw;
+    }
+
+    finish_sending();
+    // Destructor restores them as well when sending failed, reporting no error
+    ticker.restore_thread_settings();
+    return ticker.get_statistics();
+}
+
+void fpga_sender::start_sending(async_serial_writer* writer, realtime_ticker* ticker, acknowledged_link* link)
+{
+    std::lock_guard<std::mutex> lock(send_mx);
+    active_writer = writer;
+    active_realtime_ticker = ticker;
+    active_link = link;
+    // Stop requested before sending got here still ends it, without waiting for the first deadline
+    if (stop_requested()) {
+        cancel_active();
+    }
+}
+
+void fpga_sender::finish_sending()
+{
+    std::lock_guard<std::mutex> lock(send_mx);
+    active_writer = nullptr;
+    active_realtime_ticker = nullptr;
+    active_link = nullptr;
+}
+
+void fpga_sender::record_ticks(const size_t elapsed_ticks, const std::chrono::nanoseconds& lateness)
+{
+    metrics.add_loop_iteration();
+    metrics.add_missed_deadlines(elapsed_ticks - 1);
+    metrics.record_tick_lateness(lateness);
+}
+
+void fpga_sender::publish_progress(const uint8_t symbol, const size_t character, const size_t frame_size)
+{
+    ticker_progress current;
+    current.sequence = ++progress_sequence;
+    current.character = character;
+    current.frame_size = frame_size;
+    current.symbol = symbol;
+    progress.publish(current);
+}
+
+bool fpga_sender::poll_progress(ticker_progress& latest)
+{
+    return progress.take(latest);
+}
+
+metrics_snapshot fpga_sender::get_metrics() const
+{
+    return metrics.snapshot(fpga_device->get_write_calls());
+}
+
+void fpga_sender::update_text(const std::string& text)
+{
+    pending_characters.publish(encode_frame(text));
+}
+
+void fpga_sender::set_period(const std::chrono::steady_clock::duration& ticker_period)
+{
+    if (ticker_period <= std::chrono::steady_clock::duration::zero()) {
+        throw std::invalid_argument("Ticker period must be positive");
+    }
+    {
+        std::lock_guard<std::mutex> lock(send_mx);
+        pending_period = ticker_period;
+        has_pending_period = true;
+    }
+    send_cv.notify_all();
+}
+
+void fpga_sender::splice_frame(std::unique_ptr<frame_exchange::frame> characters)
+{
+    if (!characters || characters->empty()) {
+        throw std::invalid_argument("Frame to send is empty");
+    }
+    spliced_characters.publish(std::move(characters));
+}
+
+bool fpga_sender::take_pending(std::unique_ptr<frame_exchange::frame>& characters, size_t& current_character)
+{
+    // New text starts from its first character at the tick boundary it was picked up on
+    if (auto next_characters = pending_characters.take()) {
+        characters = std::move(next_characters);
+        current_character = 0;
+        return true;
+    }
+    // Spliced frame continues from the same place, wrapped if it got shorter
+    if (auto next_characters = spliced_characters.take()) {
+        characters = std::move(next_characters);
+        current_character %= characters->size();
+    }
+    return false;
+}
+
+size_t fpga_sender::send_ticks(async_serial_writer& writer, std::unique_ptr<frame_exchange::frame>& characters,
+    size_t current_character, const size_t elapsed_ticks, const missed_deadline_policy policy)
+{
+    if (take_pending(characters, current_character)) {
+        write_cyclic(writer, *characters, 0, 1);
+        publish_progress(characters->front(), 0, characters->size());
+        return 0;
+    }
+
+    const size_t next_character = (current_character + elapsed_ticks) % characters->size();
+    // Device that did not take previous character within a whole period is falling behind: when skipping,
+    // the character due now is dropped as well instead of queueing behind it
+    if ((policy == missed_deadline_policy::skip) && (writer.queue_depth() != 0)) {
+        metrics.add_dropped_tick();
+        writer.process();
+        return next_character;
+    }
+
+    // Catching up on more than one full cycle would only repeat the text
+    const size_t burst = (policy == missed_deadline_policy::catch_up) ? std::min(elapsed_ticks, characters->size()) : 1;
+    write_cyclic(writer, *characters, (current_character + elapsed_ticks - burst + 1) % characters->size(), burst);
+    publish_progress((*characters)[next_character], next_character, characters->size());
+    return next_character;
+}
+
+size_t fpga_sender::send_frame_ticks(async_serial_writer& writer, std::unique_ptr<frame_exchange::frame>& characters,
+    display_frames& frames, const effect_options& effect, size_t current_frame, const size_t elapsed_ticks,
+    const missed_deadline_policy policy)
+{
+    // Frames are computed again only when text changes, never per tick
+    const frame_exchange::frame* previous_characters = characters.get();
+    const bool restarted = take_pending(characters, current_frame);
+    if (characters.get() != previous_characters) {
+        frames = display_frames(*characters, effect);
+        current_frame = restarted ? 0 : (current_frame % frames.size());
+        write_frame(writer, frames.frame(current_frame), frames.digits());
+        publish_progress(frames.frame(current_frame)[frames.digits() - 1], current_frame, frames.size());
+        return current_frame;
+    }
+
+    const size_t next_frame = (current_frame + elapsed_ticks) % frames.size();
+    if ((policy == missed_deadline_policy::skip) && (writer.queue_depth() != 0)) {
+        metrics.add_dropped_tick();
+        writer.process();
+        return next_frame;
+    }
+
+    // Each frame replaces the previous one on the display, so missed frames are not worth sending even when
+    // catching up: only the one due now is queued
+    write_frame(writer, frames.frame(next_frame), frames.digits());
+    publish_progress(frames.frame(next_frame)[frames.digits() - 1], next_frame, frames.size());
+    return next_frame;
+}
+
+void fpga_sender::send_file_frame_ticks(async_serial_writer& writer, mapped_text_source& source,
+    frame_stream& stream, const size_t elapsed_ticks, const missed_deadline_policy policy)
+{
+    if ((policy == missed_deadline_policy::skip) && (writer.queue_depth() != 0)) {
+        metrics.add_dropped_tick();
+        stream.skip(elapsed_ticks);
+        writer.process();
+        return;
+    }
+
+    stream.skip(elapsed_ticks - 1);
+    const uint8_t* frame = stream.next();
+    write_frame(writer, frame, stream.digits());
+    publish_progress(frame[stream.digits() - 1], source.get_position(), source.get_size());
+}
+
+size_t fpga_sender::send_acknowledged_ticks(acknowledged_link& link,
+    std::unique_ptr<frame_exchange::frame>& characters, size_t current_character, const size_t elapsed_ticks,
+    const missed_deadline_policy policy)
+{
+    if (take_pending(characters, current_character)) {
+        send_acknowledged_cyclic(link, *characters, 0, 1, true);
+        publish_progress(characters->front(), 0, characters->size());
+        return 0;
+    }
+
+    // Full window means board has not confirmed a whole window of ticks, so it is skipped like a busy writer
+    const size_t next_character = (current_character + elapsed_ticks) % characters->size();
+    const size_t burst = (policy == missed_deadline_policy::catch_up)
+        ? std::min({ elapsed_ticks, characters->size(), link_packet::max_payload }) : 1;
+    const size_t first = (current_character + elapsed_ticks - burst + 1) % characters->size();
+    if (!send_acknowledged_cyclic(link, *characters, first, burst, policy != missed_deadline_policy::skip)) {
+        metrics.add_dropped_tick();
+        return next_character;
+    }
+    publish_progress((*characters)[next_character], next_character, characters->size());
+    return next_character;
+}
+
+bool fpga_sender::send_acknowledged_cyclic(acknowledged_link& link, const std::vector<std::uint8_t>& characters,
+    size_t first, size_t count, const bool wait)
+{
+    // Run may wrap past frame end, packet gets it as one contiguous copy
+    uint8_t payload[link_packet::max_payload];
+    while (count > 0) {
+        const size_t chunk = std::min(count, link_packet::max_payload);
+        for (size_t character_no = 0; character_no < chunk; ++character_no) {
+            payload[character_no] = characters[(first + character_no) % characters.size()];
+        }
+        if (!(wait ? link.send(payload, chunk) : link.try_send(payload, chunk))) {
+            return false;
+        }
+        metrics.add_bytes_sent(chunk);
+        count -= chunk;
+        first = (first + chunk) % characters.size();
+    }
+    return true;
+}
+
+void fpga_sender::send_file_ticks(async_serial_writer& writer, mapped_text_source& source,
+    std::vector<std::uint8_t>& symbols, const size_t elapsed_ticks, const missed_deadline_policy policy)
+{
+    // Same rules as send_ticks, with the file cursor instead of index modulo frame size
+    if ((policy == missed_deadline_policy::skip) && (writer.queue_depth() != 0)) {
+        metrics.add_dropped_tick();
+        source.skip(elapsed_ticks);
+        writer.process();
+        return;
+    }
+
+    const size_t burst = (policy == missed_deadline_policy::catch_up) ? std::min(elapsed_ticks, symbols.size()) : 1;
+    source.skip(elapsed_ticks - burst);
+    source.read(symbols.data(), burst);
+    write_cyclic(writer, symbols, 0, burst);
+    publish_progress(symbols[burst - 1], source.get_position(), source.get_size());
+}
+
+void fpga_sender::write_frame(async_serial_writer& writer, const uint8_t* frame, const size_t digits)
+{
+    // Whole frame goes in one batch, so the device gets it in as few writes as it accepts
+    while (!writer.is_cancelled() && (writer.submit(frame, digits) == 0)) {
+        writer.process_until(async_serial_writer::clock::now() + flush_interval);
+    }
+}
+
+void fpga_sender::write_cyclic(async_serial_writer& writer, const std::vector<std::uint8_t>& characters,
+    size_t first, size_t count)
+{
+    while ((count > 0) && !writer.is_cancelled()) {
+        const size_t chunk = std::min({ count, characters.size() - first, writer.capacity() - writer.queue_depth() });
+        if ((chunk == 0) || (writer.submit(characters.data() + first, chunk) == 0)) {
+            writer.process_until(async_serial_writer::clock::now() + flush_interval);
+            continue;
+        }
+        count -= chunk;
+        first = (first + chunk) % characters.size();
+    }
+}
+
+void fpga_sender::run_ticks(const tick_waiter& wait_ticks, const std::function<void(const size_t)>& on_ticks)
+{
+    std::chrono::nanoseconds lateness(0);
+    size_t elapsed_ticks;
+    while (!stop_requested() && ((elapsed_ticks = wait_ticks(lateness)) != 0)) {
+        record_ticks(elapsed_ticks, lateness);
+        on_ticks(elapsed_ticks);
+    }
+}
+
+fpga_sender::tick_waiter fpga_sender::scheduled_ticks(ticker_scheduler& scheduler, async_serial_writer& writer)
+{
+    return [this, &scheduler, &writer](std::chrono::nanoseconds& lateness) {
+        writer.process_until(scheduler.next_deadline());
+        return wait_scheduled(scheduler, lateness);
     };
+}
 
-    std::vector<std::uint8_t> result;
-    for (const std::string::value_type text_character : text) {
-        try {
-            const std::vector<std::uint8_t>& seven_segment_symbols = seven_segment_characters.at(std::tolower(text_character));
-            for (const uint8_t symbol : seven_segment_symbols) {
-                result.push_back(symbol);
+size_t fpga_sender::wait_scheduled(ticker_scheduler& scheduler, std::chrono::nanoseconds& lateness)
+{
+    size_t elapsed_ticks = 0;
+    {
+        std::unique_lock<std::mutex> lock(send_mx);
+        while (!stop_requested()) {
+            if (has_pending_period) {
+                scheduler.set_period(pending_period);
+                has_pending_period = false;
+            }
+            elapsed_ticks = scheduler.wait(lock, send_cv, [this] { return stop_requested() || has_pending_period; });
+            if (elapsed_ticks != 0) {
+                break;
             }
-        } catch (const std::out_of_range&) {
-            throw std::runtime_error(std::string("Symbol ") + text_character + " is not supported");
         }
     }
-    result.shrink_to_fit();
+    lateness = std::chrono::duration_cast<std::chrono::nanoseconds>(scheduler.get_last_lateness());
+    return elapsed_ticks;
+}
+
+std::unique_ptr<frame_exchange::frame> fpga_sender::encode_frame(const std::string& text) const
+{
+    auto characters = std::make_unique<frame_exchange::frame>(transform_text(text, *font));
+    if (characters->empty()) {
+        throw std::runtime_error("Text to send is empty");
+    }
+    return characters;
+}
+
+std::vector<std::uint8_t> fpga_sender::transform_text(const std::string &text, const glyph_font& font)
+{
+    const encode_status required = font.measure(text);
+    if (!required.ok()) {
+        size_t length;
+        glyph_font::decode(text.data(), text.size(), required.unsupported_position, length);
+        throw std::runtime_error("Symbol " + text.substr(required.unsupported_position, length) + " is not supported");
+    }
+
+    std::vector<std::uint8_t> result(required.size);
+    font.encode(text, result.data(), result.size());
     return result;
 }
 
 void fpga_sender::stop()
 {
-    should_send = false;
+    {
+        std::lock_guard<std::mutex> lock(send_mx);
+        ++stop_requests;
+        cancel_active();
+    }
     send_cv.notify_all();
 }
+
+void fpga_sender::rearm()
+{
+    std::lock_guard<std::mutex> lock(send_mx);
+    accepted_stop_requests = stop_requests.load();
+    has_pending_period = false;
+}
+
+bool fpga_sender::stop_requested() const
+{
+    return stop_requests != accepted_stop_requests;
+}
+
+void fpga_sender::cancel_active()
+{
+    if (active_realtime_ticker) {
+        active_realtime_ticker->cancel();
+    }
+    if (active_writer) {
+        active_writer->cancel();
+    }
+    if (active_link) {
+        active_link->cancel();
+    }
+}
@@ -6,23 +6,143 @@
 #include <memory>
 #include <vector>
 #include <chrono>
+#include <mutex>
 #include <atomic>
 #include <condition_variable>
+#include <functional>
 #include "serial_device.h"
+#include "ticker_scheduler.h"
+#include "realtime_ticker.h"
+#include "frame_exchange.h"
+#include "async_serial_writer.h"
+#include "sender_metrics.h"
+#include "latest_value_slot.h"
+#include "mapped_text_source.h"
+#include "acknowledged_link.h"
+#include "glyph_font.h"
+#include "display_effects.h"
 
 namespace fpga_ticker_client {
+    // Last symbol handed to device and its place in the sent text
+    struct ticker_progress {
+        uint64_t sequence = 0;
+        size_t character = 0;
+        size_t frame_size = 0;
+        uint8_t symbol = 0xFF;
+    };
+
     class fpga_sender {
     public:
-        explicit fpga_sender(const std::shared_ptr<serial_device>& fpga_device);
+        explicit fpga_sender(const std::shared_ptr<serial_device>& fpga_device,
+            const std::shared_ptr<const glyph_font>& font = glyph_font::builtin());
 
-        void send(const std::string& text, const std::chrono::system_clock::duration& ticker_period);
+        void send(const std::string& text, const std::chrono::steady_clock::duration& ticker_period,
+            const missed_deadline_policy policy = missed_deadline_policy::skip);
+        // Carries on with periodic text send that failed, once device was reopened: the character it stopped at is
+        // sent again right away and ticks go on at the deadlines of the interrupted send
+        void resume();
+        bool can_resume() const;
+        // Any other send forgets interrupted one as well
+        void discard_interrupted();
+        // Streams text file of any size without encoding it up front, text updates do not apply to it
+        void send_file(const std::string& path, const std::chrono::steady_clock::duration& ticker_period,
+            const missed_deadline_policy policy = missed_deadline_policy::skip);
+        // Sends precomputed effect frames of text to multi-digit display, one whole frame per tick
+        void send_frames(const std::string& text, const std::chrono::steady_clock::duration& ticker_period,
+            const effect_options& effect, const missed_deadline_policy policy = missed_deadline_policy::skip);
+        // Streams effect frames of text file of any size, generating them as they are due
+        void send_file_frames(const std::string& path, const std::chrono::steady_clock::duration& ticker_period,
+            const effect_options& effect, const missed_deadline_policy policy = missed_deadline_policy::skip);
+        // Sends text once in upload frame to board that loops it by itself, returns when it was transmitted
+        void upload(const std::string& text, const std::chrono::microseconds& period);
+        void upload(const frame_exchange::frame& characters, const std::chrono::microseconds& period);
+        // Sends text in checksummed packets the board acknowledges, resending damaged or lost ones
+        link_statistics send_acknowledged(const std::string& text,
+            const std::chrono::steady_clock::duration& ticker_period, const link_options& options = link_options(),
+            const missed_deadline_policy policy = missed_deadline_policy::skip);
+        jitter_statistics send_realtime(const std::string& text, const realtime_options& options,
+            const missed_deadline_policy policy = missed_deadline_policy::skip);
+        // Ends running send, or the next one if none runs yet; requests stay in force until rearm()
         void stop();
+        // Forgets stop requests and period changes made so far, for a sender reused for another send after being
+        // stopped
+        void rearm();
+        // Replaces text of running or next send, taken at the next tick boundary
+        void update_text(const std::string& text);
+        // Changes period of running or next periodic send at its next tick boundary, keeping its position
+        void set_period(const std::chrono::steady_clock::duration& ticker_period);
+        // Replaces frame of running send keeping current position, for small edits of shown text
+        void splice_frame(std::unique_ptr<frame_exchange::frame> characters);
+        // Counters accumulated over all sends of this sender, safe to call while sending
+        metrics_snapshot get_metrics() const;
+        // Newest progress since previous call, for a single polling reader such as UI timer
+        bool poll_progress(ticker_progress& latest);
+
+        static std::vector<std::uint8_t> transform_text(const std::string& text,
+            const glyph_font& font = *glyph_font::builtin());
 
     private:
-        std::vector<std::uint8_t> transform_text(const std::string& text) const;
-        std::atomic_bool should_send;
-        std::condition_variable send_cv;
+        // Where periodic text send was when sending failed
+        struct interrupted_send {
+            std::unique_ptr<frame_exchange::frame> characters;
+            size_t character = 0;
+            std::chrono::steady_clock::time_point deadline;
+            std::chrono::steady_clock::duration period;
+            missed_deadline_policy policy = missed_deadline_policy::skip;
+        };
+        // Waits for the next tick, returning how many elapsed and how late the last one was; 0 ends sending
+        using tick_waiter = std::function<size_t(std::chrono::nanoseconds& lateness)>;
+
+        void send_periodic(std::unique_ptr<frame_exchange::frame> characters, size_t current_character,
+            const std::chrono::steady_clock::time_point& start,
+            const std::chrono::steady_clock::duration& ticker_period, const missed_deadline_policy policy);
+        // Hands elapsed ticks to on_ticks until stop is requested or wait_ticks returns 0
+        void run_ticks(const tick_waiter& wait_ticks, const std::function<void(const size_t)>& on_ticks);
+        // Flushes writer until the next deadline before each wait
+        tick_waiter scheduled_ticks(ticker_scheduler& scheduler, async_serial_writer& writer);
+        size_t wait_scheduled(ticker_scheduler& scheduler, std::chrono::nanoseconds& lateness);
+        std::unique_ptr<frame_exchange::frame> encode_frame(const std::string& text) const;
+        bool stop_requested() const;
+        // Called with send_mx held
+        void cancel_active();
+        void start_sending(async_serial_writer* writer, realtime_ticker* ticker, acknowledged_link* link = nullptr);
+        void finish_sending();
+        void publish_progress(const uint8_t symbol, const size_t character, const size_t frame_size);
+        void send_file_ticks(async_serial_writer& writer, mapped_text_source& source,
+            std::vector<std::uint8_t>& symbols, const size_t elapsed_ticks, const missed_deadline_policy policy);
+        void record_ticks(const size_t elapsed_ticks, const std::chrono::nanoseconds& lateness);
+        bool take_pending(std::unique_ptr<frame_exchange::frame>& characters, size_t& current_character);
+        size_t send_ticks(async_serial_writer& writer, std::unique_ptr<frame_exchange::frame>& characters,
+            size_t current_character, const size_t elapsed_ticks, const missed_deadline_policy policy);
+        size_t send_frame_ticks(async_serial_writer& writer, std::unique_ptr<frame_exchange::frame>& characters,
+            display_frames& frames, const effect_options& effect, size_t current_frame, const size_t elapsed_ticks,
+            const missed_deadline_policy policy);
+        void send_file_frame_ticks(async_serial_writer& writer, mapped_text_source& source, frame_stream& stream,
+            const size_t elapsed_ticks, const missed_deadline_policy policy);
+        size_t send_acknowledged_ticks(acknowledged_link& link, std::unique_ptr<frame_exchange::frame>& characters,
+            size_t current_character, const size_t elapsed_ticks, const missed_deadline_policy policy);
+        bool send_acknowledged_cyclic(acknowledged_link& link, const std::vector<std::uint8_t>& characters,
+            size_t first, size_t count, const bool wait);
+        static void write_frame(async_serial_writer& writer, const uint8_t* frame, const size_t digits);
+        static void write_cyclic(async_serial_writer& writer, const std::vector<std::uint8_t>& characters,
+            size_t first, size_t count);
+
         const std::shared_ptr<serial_device> fpga_device;
+        const std::shared_ptr<const glyph_font> font;
+        std::atomic<uint64_t> stop_requests, accepted_stop_requests;
+        std::mutex send_mx;
+        std::condition_variable send_cv;
+        // Guarded by send_mx
+        bool has_pending_period;
+        std::chrono::steady_clock::duration pending_period;
+        realtime_ticker* active_realtime_ticker;
+        async_serial_writer* active_writer;
+        acknowledged_link* active_link;
+        frame_exchange pending_characters, spliced_characters;
+        sender_metrics metrics;
+        latest_value_slot<ticker_progress> progress;
+        uint64_t progress_sequence;
+        interrupted_send interrupted;
     };
 }
 
@@ -0,0 +1,269 @@
+#include "fpga_ticker_client_sessions_wx_frame.h"
+#include <vector>
+#include <wx/valnum.h>
+
+using namespace fpga_ticker_client;
+
+namespace {
+    enum session_column {
+        device_column,
+        speed_column,
+        period_column,
+        text_column,
+        sent_column,
+        dropped_column,
+        missed_column,
+        lateness_column,
+        position_column,
+        state_column
+    };
+}
+
+fpga_ticker_client_sessions_wx_frame::fpga_ticker_client_sessions_wx_frame(wxWindow* parent)
+    : wxFrame(parent, wxID_ANY, "FPGA ticker sessions", wxDefaultPosition, wxSize(900, 500)),
+    status_timer(this, status_timer_id), pool(std::make_unique<session_pool>())
+{
+    const uint8_t border = 10, gap = 5;
+
+    panel = new wxPanel(this);
+
+    auto input_sizer = new wxFlexGridSizer(4, 2, gap, gap);
+    input_sizer->AddGrowableCol(1, 1);
+
+    device_input = new wxTextCtrl(panel, wxID_ANY);
+    text_input = new wxTextCtrl(panel, wxID_ANY);
+    period_input = new wxTextCtrl(panel, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize, 0,
+        wxIntegerValidator<uint32_t>());
+    speed_input = new wxTextCtrl(panel, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize, 0,
+        wxIntegerValidator<uint32_t>());
+
+    const std::vector<std::pair<wxString, wxTextCtrl*>> inputs = {
+        { "FPGA device path", device_input },
+        { "Text to send", text_input },
+        { "Period for each character, ms", period_input },
+        { "Port speed", speed_input }
+    };
+
+    for (const auto& input : inputs) {
+        input_sizer->Add(new wxStaticText(panel, wxID_ANY, input.first), 0, wxALIGN_CENTER_VERTICAL);
+        input_sizer->Add(input.second, 1, wxEXPAND);
+    }
+
+    add_button = new wxButton(panel, add_button_id, "Add session");
+    update_button = new wxButton(panel, update_button_id, "Update selected");
+    update_button->Enable(false);
+    remove_button = new wxButton(panel, remove_button_id, "Remove selected");
+    remove_button->Enable(false);
+    auto buttons_sizer = new wxBoxSizer(wxHORIZONTAL);
+    buttons_sizer->Add(add_button, 0, wxLEFT | wxRIGHT | wxALIGN_CENTER, border);
+    buttons_sizer->Add(update_button, 0, wxLEFT | wxRIGHT | wxALIGN_CENTER, border);
+    buttons_sizer->Add(remove_button, 0, wxLEFT | wxRIGHT | wxALIGN_CENTER, border);
+
+    sessions_view = new wxListView(panel, wxID_ANY, wxDefaultPosition, wxDefaultSize,
+        wxLC_REPORT | wxLC_SINGLE_SEL);
+    sessions_view->AppendColumn("Device");
+    sessions_view->AppendColumn("Speed", wxLIST_FORMAT_RIGHT);
+    sessions_view->AppendColumn("Period, ms", wxLIST_FORMAT_RIGHT);
+    sessions_view->AppendColumn("Text", wxLIST_FORMAT_LEFT, 160);
+    sessions_view->AppendColumn("Sent", wxLIST_FORMAT_RIGHT);
+    sessions_view->AppendColumn("Dropped", wxLIST_FORMAT_RIGHT);
+    sessions_view->AppendColumn("Missed ticks", wxLIST_FORMAT_RIGHT);
+    sessions_view->AppendColumn("Max lateness, us", wxLIST_FORMAT_RIGHT);
+    sessions_view->AppendColumn("Position", wxLIST_FORMAT_RIGHT);
+    sessions_view->AppendColumn("State", wxLIST_FORMAT_LEFT, 160);
+
+    auto panel_sizer = new wxBoxSizer(wxVERTICAL);
+    panel_sizer->Add(input_sizer, 0, wxALL | wxEXPAND, border);
+    panel_sizer->Add(buttons_sizer, 0, wxLEFT | wxRIGHT | wxBOTTOM, border);
+    panel_sizer->Add(sessions_view, 1, wxLEFT | wxRIGHT | wxBOTTOM | wxEXPAND, border);
+    panel->SetSizer(panel_sizer);
+    CreateStatusBar();
+    SetStatusText(wxString::Format("No sessions, %zu workers", pool->get_workers()));
+
+    Bind(wxEVT_BUTTON, &fpga_ticker_client_sessions_wx_frame::on_add_session, this, add_button_id);
+    Bind(wxEVT_BUTTON, &fpga_ticker_client_sessions_wx_frame::on_update_session, this, update_button_id);
+    Bind(wxEVT_BUTTON, &fpga_ticker_client_sessions_wx_frame::on_remove_session, this, remove_button_id);
+    Bind(wxEVT_TIMER, &fpga_ticker_client_sessions_wx_frame::on_status_timer, this, status_timer_id);
+    Bind(wxEVT_CLOSE_WINDOW, &fpga_ticker_client_sessions_wx_frame::on_close, this);
+    sessions_view->Bind(wxEVT_LIST_ITEM_SELECTED, [this](wxListEvent&) {
+        update_button->Enable(true);
+        remove_button->Enable(true);
+    });
+    sessions_view->Bind(wxEVT_LIST_ITEM_DESELECTED, [this](wxListEvent&) {
+        update_button->Enable(false);
+        remove_button->Enable(false);
+    });
+
+    status_timer.Start(status_interval_ms);
+}
+
+std::chrono::milliseconds fpga_ticker_client_sessions_wx_frame::get_period() const
+{
+    unsigned long period = 0;
+    period_input->GetValue().ToULong(&period, 10);
+    return std::chrono::milliseconds(period);
+}
+
+bool fpga_ticker_client_sessions_wx_frame::get_selected_session(size_t& session_id) const
+{
+    const long selected = sessions_view->GetFirstSelected();
+    if (selected == -1) {
+        return false;
+    }
+    session_id = static_cast<size_t>(sessions_view->GetItemData(selected));
+    return true;
+}
+
+void fpga_ticker_client_sessions_wx_frame::on_add_session(wxCommandEvent& event)
+{
+    if (event.GetId() != add_button_id) {
+        event.Skip();
+        return;
+    }
+    if (!panel->Validate()) {
+        return;
+    }
+
+    unsigned long speed = 0;
+    speed_input->GetValue().ToULong(&speed, 10);
+    session_settings settings;
+    settings.device_path = std::string(device_input->GetValue().utf8_str());
+    settings.speed = static_cast<uint32_t>(speed);
+    settings.text = std::string(text_input->GetValue().utf8_str());
+    settings.period = get_period();
+
+    try {
+        pool->add_session(settings);
+    } catch (const std::exception& e) {
+        wxMessageBox(std::string("Error adding session: ") + e.what(), "Error", wxICON_ERROR);
+        return;
+    }
+    refresh_status();
+}
+
+void fpga_ticker_client_sessions_wx_frame::on_update_session(wxCommandEvent& event)
+{
+    size_t session_id;
+    if (event.GetId() != update_button_id) {
+        event.Skip();
+        return;
+    }
+    if (!get_selected_session(session_id)) {
+        return;
+    }
+
+    // Empty inputs leave the setting as it is
+    try {
+        const std::string text = std::string(text_input->GetValue().utf8_str());
+        if (!text.empty()) {
+            pool->update_text(session_id, text);
+        }
+        if (!period_input->GetValue().empty()) {
+            pool->set_period(session_id, get_period());
+        }
+    } catch (const std::exception& e) {
+        wxMessageBox(std::string("Error updating session: ") + e.what(), "Error", wxICON_ERROR);
+        return;
+    }
+    refresh_status();
+}
+
+void fpga_ticker_client_sessions_wx_frame::on_remove_session(wxCommandEvent& event)
+{
+    size_t session_id;
+    if (event.GetId() != remove_button_id) {
+        event.Skip();
+        return;
+    }
+    if (!get_selected_session(session_id)) {
+        return;
+    }
+
+    try {
+        pool->remove_session(session_id);
+    } catch (const std::exception& e) {
+        wxMessageBox(std::string("Error removing session: ") + e.what(), "Error", wxICON_ERROR);
+    }
+    refresh_status();
+}
+
+void fpga_ticker_client_sessions_wx_frame::on_status_timer(wxTimerEvent&)
+{
+    if (IsShown()) {
+        refresh_status();
+    }
+}
+
+void fpga_ticker_client_sessions_wx_frame::on_close(wxCloseEvent& event)
+{
+    if (event.CanVeto()) {
+        Hide();
+        event.Veto();
+    } else {
+        event.Skip();
+    }
+}
+
+void fpga_ticker_client_sessions_wx_frame::refresh_status()
+{
+    const std::vector<session_status> statuses = pool->get_status();
+
+    // Whole list is updated in one pass between Freeze and Thaw, so it is repainted once per refresh
+    sessions_view->Freeze();
+    size_t selected_id = 0;
+    const bool has_selection = get_selected_session(selected_id);
+    while (static_cast<size_t>(sessions_view->GetItemCount()) < statuses.size()) {
+        sessions_view->InsertItem(sessions_view->GetItemCount(), wxEmptyString);
+    }
+    while (static_cast<size_t>(sessions_view->GetItemCount()) > statuses.size()) {
+        sessions_view->DeleteItem(sessions_view->GetItemCount() - 1);
+    }
+
+    // Every row is rewritten, as session removed and another added between refreshes leave the count as it was
+    for (size_t row = 0; row < statuses.size(); ++row) {
+        const session_status& status = statuses[row];
+        const auto item = static_cast<long>(row);
+        sessions_view->SetItem(item, device_column, wxString(status.device_path));
+        sessions_view->SetItemData(item, static_cast<long>(status.id));
+        const bool keep_selected = has_selection && (status.id == selected_id);
+        if (sessions_view->IsSelected(item) != keep_selected) {
+            sessions_view->Select(item, keep_selected);
+        }
+        const auto period = std::chrono::duration_cast<std::chrono::milliseconds>(status.period);
+        const auto lateness = std::chrono::duration_cast<std::chrono::microseconds>(status.max_lateness);
+        sessions_view->SetItem(item, speed_column, wxString::Format("%u", status.speed));
+        sessions_view->SetItem(item, period_column, wxString::Format("%lld",
+            static_cast<long long>(period.count())));
+        sessions_view->SetItem(item, text_column, wxString::FromUTF8(status.text.c_str()));
+        sessions_view->SetItem(item, sent_column, wxString::Format("%llu",
+            static_cast<unsigned long long>(status.bytes_sent)));
+        sessions_view->SetItem(item, dropped_column, wxString::Format("%llu",
+            static_cast<unsigned long long>(status.dropped_characters)));
+        sessions_view->SetItem(item, missed_column, wxString::Format("%llu",
+            static_cast<unsigned long long>(status.missed_ticks)));
+        sessions_view->SetItem(item, lateness_column, wxString::Format("%lld",
+            static_cast<long long>(lateness.count())));
+        sessions_view->SetItem(item, position_column, wxString::Format("%zu of %zu", status.character + 1,
+            status.frame_size));
+        wxString state("sending");
+        if (status.failed) {
+            state = wxString("failed: " + status.error);
+        } else if (status.reconnecting) {
+            state = wxString("waiting for device: " + status.error);
+        }
+        sessions_view->SetItem(item, state_column, state);
+    }
+    const bool selected = sessions_view->GetFirstSelected() != -1;
+    update_button->Enable(selected);
+    remove_button->Enable(selected);
+    sessions_view->Thaw();
+
+    SetStatusText(wxString::Format("%zu sessions on %zu workers", statuses.size(), pool->get_workers()));
+}
+
+fpga_ticker_client_sessions_wx_frame::~fpga_ticker_client_sessions_wx_frame()
+{
+    status_timer.Stop();
+    // Workers are joined and devices closed before the window goes away
+    pool.reset();
+}
@@ -0,0 +1,51 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_FPGA_TICKER_CLIENT_SESSIONS_WX_FRAME_H
+#define DDS_FPGA_TICKER_CLIENT_FPGA_TICKER_CLIENT_SESSIONS_WX_FRAME_H
+
+
+#include <wx/wxprec.h>
+#ifndef WX_PRECOMP
+#include <wx/wx.h>
+#endif
+#include <wx/listctrl.h>
+
+#include <memory>
+#include <chrono>
+#include "session_pool.h"
+
+namespace fpga_ticker_client {
+    /*
+     * Many tickers at once, each with its own device, speed, period and text, all ticked by one shared
+     * session_pool. The list is refreshed from a single status snapshot per timer tick, never from workers.
+     * Closing the window only hides it, sessions keep running until removed or the main window is closed.
+     */
+    class fpga_ticker_client_sessions_wx_frame : public wxFrame {
+    public:
+        explicit fpga_ticker_client_sessions_wx_frame(wxWindow* parent);
+        ~fpga_ticker_client_sessions_wx_frame() final;
+
+    private:
+        void on_add_session(wxCommandEvent& event);
+        void on_remove_session(wxCommandEvent& event);
+        void on_update_session(wxCommandEvent& event);
+        void on_status_timer(wxTimerEvent& event);
+        void on_close(wxCloseEvent& event);
+        void refresh_status();
+        bool get_selected_session(size_t& session_id) const;
+        std::chrono::milliseconds get_period() const;
+
+        wxPanel* panel;
+        wxTextCtrl* device_input, * text_input, * period_input, * speed_input;
+        wxButton* add_button, * remove_button, * update_button;
+        wxListView* sessions_view;
+        wxTimer status_timer;
+        std::unique_ptr<session_pool> pool;
+
+        static const wxWindowID add_button_id = wxID_ADD, remove_button_id = wxID_REMOVE,
+            update_button_id = wxID_APPLY;
+        static const wxWindowID status_timer_id = wxID_HIGHEST + 1;
+        static const int status_interval_ms = 250;
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_FPGA_TICKER_CLIENT_SESSIONS_WX_FRAME_H
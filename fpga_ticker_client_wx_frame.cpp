@@ -5,7 +5,8 @@
 using namespace fpga_ticker_client;
 
 fpga_ticker_client_wx_frame::fpga_ticker_client_wx_frame()
-    : wxFrame(nullptr, wxID_ANY, "FPGA ticker"), sending_thread(), sender()
+    : wxFrame(nullptr, wxID_ANY, "FPGA ticker"), stats_timer(this, stats_timer_id),
+    preview_timer(this, preview_timer_id), sent_period(0), sessions_frame(nullptr)
 {
     const uint8_t border = 10, gap = 5;
 
@@ -36,53 +37,97 @@ fpga_ticker_client_wx_frame::fpga_ticker_client_wx_frame()
         input_sizer->AddGrowableRow(input_no, 1);
     }
 
+    realtime_input = new wxCheckBox(panel, wxID_ANY, "Realtime mode (period in microseconds)");
+
     start_button = new wxButton(panel, start_button_id, "Start");
     start_button->Enable(true);
     stop_button = new wxButton(panel, stop_button_id, "Stop");
     stop_button->Enable(false);
+    update_button = new wxButton(panel, update_button_id, "Update text");
+    update_button->Enable(false);
+    sessions_button = new wxButton(panel, sessions_button_id, "Sessions...");
     auto buttons_sizer = new wxBoxSizer(wxHORIZONTAL);
     buttons_sizer->Add(start_button, 0, wxLEFT | wxRIGHT | wxALIGN_CENTER, border);
     buttons_sizer->Add(stop_button, 0, wxLEFT | wxRIGHT | wxALIGN_CENTER, border);
+    buttons_sizer->Add(update_button, 0, wxLEFT | wxRIGHT | wxALIGN_CENTER, border);
+    buttons_sizer->Add(sessions_button, 0, wxLEFT | wxRIGHT | wxALIGN_CENTER, border);
+
+    preview = new seven_segment_preview(panel);
+    position_text = new wxStaticText(panel, wxID_ANY, wxEmptyString);
+    auto preview_sizer = new wxBoxSizer(wxHORIZONTAL);
+    preview_sizer->Add(preview, 0, wxRIGHT | wxALIGN_CENTER, border);
+    preview_sizer->Add(position_text, 1, wxALIGN_CENTER);
+
+    stats_text = new wxStaticText(panel, wxID_ANY, wxEmptyString);
+    stats_text->SetFont(wxFont(wxFontInfo().Family(wxFONTFAMILY_TELETYPE)));
 
     auto panel_sizer = new wxBoxSizer(wxVERTICAL);
     panel_sizer->Add(input_sizer, 1, wxALL | wxEXPAND, border);
+    panel_sizer->Add(realtime_input, 0, wxLEFT | wxRIGHT | wxEXPAND, border);
     panel_sizer->Add(buttons_sizer, 1, wxALL, border);
+    panel_sizer->Add(preview_sizer, 0, wxLEFT | wxRIGHT | wxBOTTOM | wxEXPAND, border);
+    panel_sizer->Add(stats_text, 0, wxLEFT | wxRIGHT | wxBOTTOM | wxEXPAND, border);
     panel->SetSizer(panel_sizer);
+    CreateStatusBar();
 
     Bind(wxEVT_BUTTON, &fpga_ticker_client_wx_frame::on_start_sending, this, start_button_id);
     Bind(wxEVT_BUTTON, &fpga_ticker_client_wx_frame::on_stop_sending, this, stop_button_id);
+    Bind(wxEVT_BUTTON, &fpga_ticker_client_wx_frame::on_update_text, this, update_button_id);
+    Bind(wxEVT_BUTTON, &fpga_ticker_client_wx_frame::on_open_sessions, this, sessions_button_id);
+    Bind(SEND_STARTED_EVENT, &fpga_ticker_client_wx_frame::on_send_start, this);
+    Bind(COMMAND_ERROR_EVENT, &fpga_ticker_client_wx_frame::on_command_error, this);
     Bind(DEVICE_OPEN_ERROR_EVENT, &fpga_ticker_client_wx_frame::on_device_open_failure, this);
     Bind(DATA_SEND_ERROR_EVENT, &fpga_ticker_client_wx_frame::on_data_send_error, this);
+    Bind(DEVICE_LOST_EVENT, &fpga_ticker_client_wx_frame::on_device_lost, this);
     Bind(SEND_STOPPED_EVENT, &fpga_ticker_client_wx_frame::on_send_stop, this);
+    Bind(wxEVT_TIMER, &fpga_ticker_client_wx_frame::on_stats_timer, this, stats_timer_id);
+    Bind(wxEVT_TIMER, &fpga_ticker_client_wx_frame::on_preview_timer, this, preview_timer_id);
+
+    worker = std::make_unique<sender_worker>([this](const sender_worker::event_type type, const std::string& message) {
+        on_worker_event(type, message);
+    });
 }
 
 void fpga_ticker_client_wx_frame::enable_inputs(const bool enable)
 {
     device_input->Enable(enable);
-    text_input->Enable(enable);
-    period_input->Enable(enable);
     speed_input->Enable(enable);
+    realtime_input->Enable(enable);
     start_button->Enable(enable);
     stop_button->Enable(!enable);
+    update_button->Enable(!enable);
+}
+
+std::chrono::microseconds fpga_ticker_client_wx_frame::get_period() const
+{
+    unsigned long period;
+    period_input->GetValue().ToULong(&period, 10);
+    return realtime_input->GetValue()
+        ? std::chrono::microseconds(period) : std::chrono::microseconds(std::chrono::milliseconds(period));
 }
 
 void fpga_ticker_client_wx_frame::on_start_sending(wxCommandEvent &event)
 {
     if (event.GetId() == start_button_id) {
         if (panel->Validate()) {
-            enable_inputs(false);
-            unsigned long period, speed;
-            period_input->GetValue().ToULong(&period, 10);
+            unsigned long speed;
             speed_input->GetValue().ToULong(&speed, 10);
 
-            const auto device = std::make_shared<serial_device>(device_input->GetValue().ToStdString(), speed);
-            if (device) {
-                sending_thread = std::make_unique<std::thread>(&fpga_ticker_client_wx_frame::sending_routine, this,
-                    device, text_input->GetValue().ToStdString(), std::chrono::milliseconds(period));
+            send_job job;
+            job.device_path = std::string(device_input->GetValue().utf8_str());
+            job.speed = static_cast<uint32_t>(speed);
+            job.text = std::string(text_input->GetValue().utf8_str());
+            job.period = get_period();
+            job.realtime = realtime_input->GetValue();
+
+            SetStatusText(wxEmptyString);
+            if (worker->start(job)) {
+                sent_period = job.period;
+                enable_inputs(false);
+                stats_timer.Start(stats_interval_ms);
+                preview_timer.Start(preview_interval_ms);
             } else {
-                const auto open_failed_event = new send_event("", this->GetId(), DEVICE_OPEN_ERROR_EVENT);
-                open_failed_event->SetEventObject(this);
-                QueueEvent(open_failed_event);
+                SetStatusText("Sender is busy, try again");
             }
         }
     } else {
@@ -93,31 +138,91 @@ void fpga_ticker_client_wx_frame::on_start_sending(wxCommandEvent &event)
 void fpga_ticker_client_wx_frame::on_stop_sending(wxCommandEvent &event)
 {
     if (event.GetId() == stop_button_id) {
-        sender->stop();
+        worker->stop();
     } else {
         event.Skip();
     }
 }
 
-void fpga_ticker_client_wx_frame::sending_routine(const std::shared_ptr<serial_device>& fpga_device,
-    const std::string& text, const std::chrono::milliseconds& period)
+void fpga_ticker_client_wx_frame::on_update_text(wxCommandEvent &event)
 {
-    send_event* event;
-    if (fpga_device->is_opened()) {
-        sender = std::make_unique<fpga_sender>(fpga_device);
+    if (event.GetId() == update_button_id) {
+        const std::string text = std::string(text_input->GetValue().utf8_str());
         try {
-            sender->send(text, period);
-            event = new send_event("", this->GetId(), SEND_STOPPED_EVENT);
+            if (fpga_sender::transform_text(text).empty()) {
+                throw std::runtime_error("Text to send is empty");
+            }
         } catch (const std::exception& e) {
-            event = new send_event(e.what(), this->GetId(), DATA_SEND_ERROR_EVENT);
+            wxMessageBox(std::string("Error updating text: ") + e.what(), "Error", wxICON_ERROR);
+            return;
+        }
+
+        bool queued = worker->update_text(text);
+        if (period_input->Validate() && (get_period() != sent_period)) {
+            sent_period = get_period();
+            queued = worker->set_period(sent_period) && queued;
+        }
+        if (!queued) {
+            SetStatusText("Sender is busy, try again");
         }
     } else {
-        event = new send_event("", this->GetId(), DEVICE_OPEN_ERROR_EVENT);
+        event.Skip();
+    }
+}
+
+void fpga_ticker_client_wx_frame::on_open_sessions(wxCommandEvent &event)
+{
+    if (event.GetId() == sessions_button_id) {
+        if (sessions_frame == nullptr) {
+            sessions_frame = new fpga_ticker_client_sessions_wx_frame(this);
+        }
+        sessions_frame->Show(true);
+        sessions_frame->Raise();
+    } else {
+        event.Skip();
+    }
+}
+
+void fpga_ticker_client_wx_frame::on_worker_event(const sender_worker::event_type type, const std::string& message)
+{
+    // Runs on worker threads, handled on UI thread through event queue
+    wxEventType event_type = SEND_STOPPED_EVENT;
+    switch (type) {
+    case sender_worker::event_type::started:
+        event_type = SEND_STARTED_EVENT;
+        break;
+    case sender_worker::event_type::device_open_error:
+        event_type = DEVICE_OPEN_ERROR_EVENT;
+        break;
+    case sender_worker::event_type::send_error:
+        event_type = DATA_SEND_ERROR_EVENT;
+        break;
+    case sender_worker::event_type::device_lost:
+        event_type = DEVICE_LOST_EVENT;
+        break;
+    case sender_worker::event_type::command_error:
+        event_type = COMMAND_ERROR_EVENT;
+        break;
+    case sender_worker::event_type::stopped:
+        event_type = SEND_STOPPED_EVENT;
+        break;
     }
+
+    const auto event = new send_event(message, this->GetId(), event_type);
     event->SetEventObject(this);
     QueueEvent(event);
 }
 
+void fpga_ticker_client_wx_frame::on_send_start(send_event& event)
+{
+    SetStatusText("Port speed: " + event.get_message());
+}
+
+void fpga_ticker_client_wx_frame::on_command_error(send_event& event)
+{
+    wxMessageBox("Error updating sender: " + event.get_message(), "Error", wxICON_ERROR);
+}
+
 void fpga_ticker_client_wx_frame::on_device_open_failure(send_event& event)
 {
     const std::string& message = event.get_message();
@@ -134,32 +239,49 @@ void fpga_ticker_client_wx_frame::on_data_send_error(send_event& event)
     enable_inputs(true);
 }
 
-void fpga_ticker_client_wx_frame::on_send_stop(send_event&)
+void fpga_ticker_client_wx_frame::on_device_lost(send_event& event)
+{
+    // Not modal: worker resumes by itself once device is back, Stop gives up waiting
+    const std::string& message = event.get_message();
+    SetStatusText("Device lost" + (!message.empty() ? " (" + message + ")" : std::string())
+        + ", waiting for it to come back");
+}
+
+void fpga_ticker_client_wx_frame::on_send_stop(send_event& event)
 {
+    SetStatusText(event.get_message());
     stop_sending();
     enable_inputs(true);
 }
 
-fpga_ticker_client_wx_frame::~fpga_ticker_client_wx_frame()
+void fpga_ticker_client_wx_frame::on_stats_timer(wxTimerEvent&)
 {
-    if (sender) {
-        sender->stop();
-    }
-    if (sending_thread && sending_thread->joinable()) {
-        sending_thread->join();
+    stats_text->SetLabel(worker->get_metrics().to_string());
+    panel->Layout();
+}
+
+void fpga_ticker_client_wx_frame::on_preview_timer(wxTimerEvent&)
+{
+    ticker_progress progress;
+    if (worker->poll_progress(progress)) {
+        preview->set_symbol(progress.symbol);
+        position_text->SetLabel(wxString::Format("Symbol %zu of %zu", progress.character + 1, progress.frame_size));
     }
 }
 
+fpga_ticker_client_wx_frame::~fpga_ticker_client_wx_frame()
+{
+    stats_timer.Stop();
+    preview_timer.Stop();
+    // Worker threads post events to this frame, they must be gone before it is
+    worker.reset();
+}
+
 void fpga_ticker_client_wx_frame::stop_sending()
 {
-    if (sender) {
-        sender->stop();
-        sender.reset();
-    }
-    if (sending_thread) {
-        if (sending_thread->joinable()) {
-            sending_thread->join();
-        }
-        sending_thread.reset();
-    }
+    stats_timer.Stop();
+    preview_timer.Stop();
+    // Keep final numbers on screen after sending ends
+    stats_text->SetLabel(worker->get_metrics().to_string());
+    panel->Layout();
 }
@@ -7,12 +7,14 @@
 #include <wx/wx.h>
 #endif
 
-#include <thread>
 #include <memory>
 #include <string>
 #include <chrono>
 #include "send_event.h"
 #include "fpga_sender.h"
+#include "sender_worker.h"
+#include "seven_segment_preview.h"
+#include "fpga_ticker_client_sessions_wx_frame.h"
 
 namespace fpga_ticker_client {
     class fpga_ticker_client_wx_frame : public wxFrame {
@@ -23,21 +25,38 @@ namespace fpga_ticker_client {
     private:
         void on_start_sending(wxCommandEvent& event);
         void on_stop_sending(wxCommandEvent& event);
+        void on_update_text(wxCommandEvent& event);
+        void on_open_sessions(wxCommandEvent& event);
+        void on_send_start(send_event& event);
+        void on_command_error(send_event& event);
         void on_device_open_failure(send_event& event);
         void on_data_send_error(send_event& event);
+        void on_device_lost(send_event& event);
         void on_send_stop(send_event& event);
-        void sending_routine(const std::shared_ptr<serial_device>& fpga_device,
-                const std::string& text, const std::chrono::milliseconds& period);
+        void on_stats_timer(wxTimerEvent& event);
+        void on_preview_timer(wxTimerEvent& event);
+        void on_worker_event(const sender_worker::event_type type, const std::string& message);
+        std::chrono::microseconds get_period() const;
         void enable_inputs(const bool enable = true);
         void stop_sending();
 
         wxPanel* panel;
         wxTextCtrl* device_input, * text_input, * period_input, * speed_input;
-        wxButton* start_button, * stop_button;
-        std::unique_ptr<std::thread> sending_thread;
-        std::unique_ptr<fpga_sender> sender;
+        wxCheckBox* realtime_input;
+        wxButton* start_button, * stop_button, * update_button, * sessions_button;
+        wxStaticText* stats_text, * position_text;
+        seven_segment_preview* preview;
+        wxTimer stats_timer, preview_timer;
+        std::chrono::microseconds sent_period;
+        std::unique_ptr<sender_worker> worker;
+        // Created on first use and owned by this frame as its child
+        fpga_ticker_client_sessions_wx_frame* sessions_frame;
 
-        static const wxWindowID start_button_id = wxID_OK, stop_button_id = wxID_STOP;
+        static const wxWindowID start_button_id = wxID_OK, stop_button_id = wxID_STOP, update_button_id = wxID_APPLY,
+            sessions_button_id = wxID_HIGHEST + 3;
+        static const wxWindowID stats_timer_id = wxID_HIGHEST + 1, preview_timer_id = wxID_HIGHEST + 2;
+        // Preview is polled at display-like rate however short the period is, ticks never post events
+        static const int stats_interval_ms = 500, preview_interval_ms = 33;
     };
 }
 
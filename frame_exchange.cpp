@@ -0,0 +1,24 @@
+#include "frame_exchange.h"
+
+using namespace fpga_ticker_client;
+
+frame_exchange::frame_exchange() : pending(nullptr)
+{ }
+
+frame_exchange::~frame_exchange()
+{
+    delete pending.load(std::memory_order_acquire);
+}
+
+void frame_exchange::publish(std::unique_ptr<frame> next)
+{
+    std::unique_ptr<frame> replaced(pending.exchange(next.release(), std::memory_order_acq_rel));
+}
+
+std::unique_ptr<frame_exchange::frame> frame_exchange::take()
+{
+    if (pending.load(std::memory_order_relaxed) == nullptr) {
+        return nullptr;
+    }
+    return std::unique_ptr<frame>(pending.exchange(nullptr, std::memory_order_acq_rel));
+}
@@ -0,0 +1,35 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_FRAME_EXCHANGE_H
+#define DDS_FPGA_TICKER_CLIENT_FRAME_EXCHANGE_H
+
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace fpga_ticker_client {
+    /*
+     * Lock-free hand-over of encoded frames from any producer to the sending thread.
+     * Each frame is owned by exactly one side at a time: a frame the sender did not take yet is freed by the next
+     * publish, a taken frame belongs to the sender.
+     */
+    class frame_exchange {
+    public:
+        using frame = std::vector<std::uint8_t>;
+
+        frame_exchange();
+        ~frame_exchange();
+        frame_exchange(const frame_exchange&) = delete;
+        frame_exchange& operator=(const frame_exchange&) = delete;
+
+        void publish(std::unique_ptr<frame> next);
+        // Returns newest frame published since previous call, or nullptr
+        std::unique_ptr<frame> take();
+
+    private:
+        std::atomic<frame*> pending;
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_FRAME_EXCHANGE_H
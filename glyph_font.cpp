@@ -0,0 +1,383 @@
+#include "glyph_font.h"
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef __unix__
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#elif defined (_WIN32) || defined(_WIN64)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#endif
+
+using namespace fpga_ticker_client;
+
+namespace {
+    bool is_blank(const char character)
+    {
+        return (character == ' ') || (character == '\t') || (character == '\r');
+    }
+
+    // Splits line into fields separated by spaces or tabs
+    std::vector<std::string> split_fields(const char* line, const size_t size)
+    {
+        std::vector<std::string> fields;
+        size_t position = 0;
+        while (position < size) {
+            while ((position < size) && is_blank(line[position])) {
+                ++position;
+            }
+            const size_t start = position;
+            while ((position < size) && !is_blank(line[position])) {
+                ++position;
+            }
+            if (position > start) {
+                fields.emplace_back(line + start, position - start);
+            }
+        }
+        return fields;
+    }
+
+    std::vector<uint32_t> parse_characters(const std::string& field)
+    {
+        if ((field.size() > 2) && (field[0] == 'U') && (field[1] == '+')) {
+            size_t parsed_length = 0;
+            unsigned long code_point = 0;
+            try {
+                code_point = std::stoul(field.substr(2), &parsed_length, 16);
+            } catch (const std::exception&) {
+                parsed_length = 0;
+            }
+            if ((parsed_length != field.size() - 2) || (code_point >= 0x110000)) {
+                throw std::invalid_argument("invalid code point " + field);
+            }
+            return { static_cast<uint32_t>(code_point) };
+        }
+
+        std::vector<uint32_t> code_points;
+        for (size_t position = 0; position < field.size(); ) {
+            size_t length;
+            const uint32_t code_point = glyph_font::decode(field.data(), field.size(), position, length);
+            if (code_point == glyph_font::replacement_character) {
+                throw std::invalid_argument("malformed UTF-8 in " + field);
+            }
+            code_points.push_back(code_point);
+            position += length;
+        }
+        return code_points;
+    }
+}
+
+glyph_font::glyph_font() : pages(code_points >> block_bits, 0), blocks(1), glyphs(1)
+{
+    blocks[0].fill(0);
+    glyphs[0] = { { }, 0 };
+    for (unsigned int character = 0; character < 0x80; ++character) {
+        const seven_segment_glyph& ascii_glyph = seven_segment_encoder::glyph(static_cast<char>(character));
+        if (ascii_glyph.length != 0) {
+            set_glyph(character, ascii_glyph);
+        }
+    }
+}
+
+std::shared_ptr<const glyph_font> glyph_font::builtin()
+{
+    static const std::shared_ptr<const glyph_font> font = std::make_shared<const glyph_font>();
+    return font;
+}
+
+uint32_t glyph_font::decode(const char* text, const size_t size, const size_t position, size_t& length)
+{
+    const auto byte = [text](const size_t offset) { return static_cast<unsigned char>(text[offset]); };
+    const unsigned char lead = byte(position);
+    length = 1;
+    if (lead < 0x80) {
+        return lead;
+    }
+
+    size_t continuation;
+    uint32_t code_point, minimum;
+    if ((lead & 0xE0) == 0xC0) {
+        continuation = 1;
+        code_point = lead & 0x1F;
+        minimum = 0x80;
+    } else if ((lead & 0xF0) == 0xE0) {
+        continuation = 2;
+        code_point = lead & 0x0F;
+        minimum = 0x800;
+    } else if ((lead & 0xF8) == 0xF0) {
+        continuation = 3;
+        code_point = lead & 0x07;
+        minimum = 0x10000;
+    } else {
+        return replacement_character;
+    }
+    if (position + continuation >= size) {
+        return replacement_character;
+    }
+
+    for (size_t byte_no = 1; byte_no <= continuation; ++byte_no) {
+        if ((byte(position + byte_no) & 0xC0) != 0x80) {
+            return replacement_character;
+        }
+        code_point = (code_point << 6) | (byte(position + byte_no) & 0x3F);
+    }
+    // Overlong forms, surrogates and values past Unicode range are malformed as well
+    if ((code_point < minimum) || ((code_point >= 0xD800) && (code_point < 0xE000)) || (code_point >= code_points)) {
+        return replacement_character;
+    }
+    length = continuation + 1;
+    return code_point;
+}
+
+seven_segment_glyph glyph_font::parse_glyph(const std::string& symbols)
+{
+    seven_segment_glyph result = { { }, 0 };
+    for (const std::string& field : split_fields(symbols.data(), symbols.size())) {
+        if (result.length == seven_segment_glyph::max_symbols) {
+            throw std::invalid_argument("glyph is longer than " + std::to_string(seven_segment_glyph::max_symbols)
+                + " symbols");
+        }
+
+        uint8_t symbol = 0xFF;
+        if ((field.size() > 2) && (field[0] == '0') && ((field[1] == 'x') || (field[1] == 'X'))) {
+            size_t parsed_length = 0;
+            unsigned long value = 0;
+            try {
+                value = std::stoul(field.substr(2), &parsed_length, 16);
+            } catch (const std::exception&) {
+                parsed_length = 0;
+            }
+            if ((parsed_length != field.size() - 2) || (value > 0xFF)) {
+                throw std::invalid_argument("invalid symbol " + field);
+            }
+            symbol = static_cast<uint8_t>(value);
+        } else if (field != "-") {
+            for (const char segment : field) {
+                if ((segment < '0') || (segment > '7')) {
+                    throw std::invalid_argument("invalid segment in " + field);
+                }
+                symbol &= static_cast<uint8_t>(~(1u << (segment - '0')));
+            }
+        }
+        result.symbols[result.length++] = symbol;
+    }
+    if (result.length == 0) {
+        throw std::invalid_argument("glyph has no symbols");
+    }
+    return result;
+}
+
+const seven_segment_glyph& glyph_font::glyph(const uint32_t code_point) const
+{
+    return glyphs[blocks[pages[code_point >> block_bits]][code_point & ((1u << block_bits) - 1)]];
+}
+
+void glyph_font::set_glyph(const uint32_t code_point, const seven_segment_glyph& glyph)
+{
+    if (code_point >= code_points) {
+        throw std::invalid_argument("Code point is out of Unicode range");
+    }
+    if ((glyph.length == 0) || (glyph.length > seven_segment_glyph::max_symbols)) {
+        throw std::invalid_argument("Glyph must have 1.." + std::to_string(seven_segment_glyph::max_symbols)
+            + " symbols");
+    }
+
+    uint16_t& page = pages[code_point >> block_bits];
+    // Shared block of unsupported code points is never written, page gets a block of its own instead
+    if (page == 0) {
+        if (blocks.size() > UINT16_MAX) {
+            throw std::length_error("Font has too many glyph blocks");
+        }
+        page = static_cast<uint16_t>(blocks.size());
+        blocks.push_back(blocks[0]);
+    }
+    uint16_t& index = blocks[page][code_point & ((1u << block_bits) - 1)];
+    if (index == 0) {
+        if (glyphs.size() > UINT16_MAX) {
+            throw std::length_error("Font has too many glyphs");
+        }
+        index = static_cast<uint16_t>(glyphs.size());
+        glyphs.push_back(glyph);
+    } else {
+        glyphs[index] = glyph;
+    }
+}
+
+void glyph_font::set_fallback(const seven_segment_glyph& glyph)
+{
+    if ((glyph.length == 0) || (glyph.length > seven_segment_glyph::max_symbols)) {
+        throw std::invalid_argument("Glyph must have 1.." + std::to_string(seven_segment_glyph::max_symbols)
+            + " symbols");
+    }
+    glyphs[0] = glyph;
+}
+
+bool glyph_font::has_fallback() const
+{
+    return glyphs[0].length != 0;
+}
+
+encode_status glyph_font::measure(const std::string_view& text) const
+{
+    // ASCII skips decoding, it is what most text consists of
+    const block& ascii = blocks[pages[0]];
+    size_t size = 0;
+    for (size_t position = 0; position < text.size(); ) {
+        const auto lead = static_cast<unsigned char>(text[position]);
+        size_t length = 1;
+        const seven_segment_glyph& character_glyph = (lead < 0x80) ? glyphs[ascii[lead]]
+            : glyph(decode(text.data(), text.size(), position, length));
+        if (character_glyph.length == 0) {
+            return { size, position };
+        }
+        size += character_glyph.length;
+        position += length;
+    }
+    return { size, encode_status::npos };
+}
+
+encode_status glyph_font::encode(const std::string_view& text, uint8_t* buffer, const size_t capacity) const
+{
+    const block& ascii = blocks[pages[0]];
+    size_t size = 0;
+    for (size_t position = 0; position < text.size(); ) {
+        const auto lead = static_cast<unsigned char>(text[position]);
+        size_t length = 1;
+        const seven_segment_glyph& character_glyph = (lead < 0x80) ? glyphs[ascii[lead]]
+            : glyph(decode(text.data(), text.size(), position, length));
+        if (character_glyph.length == 0) {
+            return { size, position };
+        }
+        if (size + character_glyph.length <= capacity) {
+            std::copy_n(character_glyph.symbols.begin(), character_glyph.length, buffer + size);
+        }
+        size += character_glyph.length;
+        position += length;
+    }
+    return { size, encode_status::npos };
+}
+
+void glyph_font::load(const char* text, const size_t size, const std::string& path)
+{
+    // Byte order mark some editors put in front of UTF-8
+    const bool has_bom = (size >= 3) && (text[0] == '\xEF') && (text[1] == '\xBB') && (text[2] == '\xBF');
+    size_t line_no = 0;
+    for (size_t line_start = has_bom ? 3 : 0; line_start < size; ) {
+        size_t line_end = line_start;
+        while ((line_end < size) && (text[line_end] != '\n')) {
+            ++line_end;
+        }
+        ++line_no;
+
+        const std::vector<std::string> fields = split_fields(text + line_start, line_end - line_start);
+        try {
+            if (!fields.empty() && (fields[0][0] != '#')) {
+                if (fields.size() < 2) {
+                    throw std::invalid_argument("glyph has no symbols");
+                }
+                std::string symbols;
+                for (size_t field_no = 1; field_no < fields.size(); ++field_no) {
+                    symbols += fields[field_no] + ' ';
+                }
+                const seven_segment_glyph parsed = parse_glyph(symbols);
+                if (fields[0] == "fallback") {
+                    set_fallback(parsed);
+                } else {
+                    for (const uint32_t code_point : parse_characters(fields[0])) {
+                        set_glyph(code_point, parsed);
+                    }
+                }
+            }
+        } catch (const std::exception& e) {
+            throw std::runtime_error(path + ":" + std::to_string(line_no) + ": " + e.what());
+        }
+        line_start = line_end + 1;
+    }
+}
+
+#ifdef __unix__
+glyph_font::glyph_font(const std::string& path) : glyph_font()
+{
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file == -1) {
+        throw std::runtime_error("Error opening " + path + ": " + std::to_string(errno));
+    }
+
+    struct stat file_status = {};
+    if (fstat(file, &file_status) == -1) {
+        const int error = errno;
+        close(file);
+        throw std::runtime_error("Error reading size of " + path + ": " + std::to_string(error));
+    }
+    const auto size = static_cast<size_t>(file_status.st_size);
+    if (size == 0) {
+        close(file);
+        return;
+    }
+
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    const int error = errno;
+    close(file);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Error mapping " + path + ": " + std::to_string(error));
+    }
+    try {
+        load(static_cast<const char*>(mapping), size, path);
+    } catch (...) {
+        munmap(mapping, size);
+        throw;
+    }
+    munmap(mapping, size);
+}
+
+#elif defined (_WIN32) || defined(_WIN64)
+glyph_font::glyph_font(const std::string& path) : glyph_font()
+{
+    const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Error opening " + path + ": " + std::to_string(GetLastError()));
+    }
+
+    LARGE_INTEGER file_size;
+    if (GetFileSizeEx(file, &file_size) == FALSE) {
+        const DWORD error = GetLastError();
+        CloseHandle(file);
+        throw std::runtime_error("Error reading size of " + path + ": " + std::to_string(error));
+    }
+    const auto size = static_cast<size_t>(file_size.QuadPart);
+    if (size == 0) {
+        CloseHandle(file);
+        return;
+    }
+
+    const HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    const void* view = (mapping != NULL) ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (view == nullptr) {
+        const DWORD error = GetLastError();
+        if (mapping != NULL) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        throw std::runtime_error("Error mapping " + path + ": " + std::to_string(error));
+    }
+    try {
+        load(static_cast<const char*>(view), size, path);
+    } catch (...) {
+        UnmapViewOfFile(view);
+        CloseHandle(mapping);
+        CloseHandle(file);
+        throw;
+    }
+    UnmapViewOfFile(view);
+    CloseHandle(mapping);
+    CloseHandle(file);
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_GLYPH_FONT_H
+#define DDS_FPGA_TICKER_CLIENT_GLYPH_FONT_H
+
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "seven_segment_encoder.h"
+
+namespace fpga_ticker_client {
+    /*
+     * Glyphs for UTF-8 text: built-in ASCII set extended by font files, looked up in a two-level table indexed
+     * by high and low bits of the code point. Font file is plain text, one glyph per line:
+     *
+     *   # comment
+     *   Жж 12345 01234          characters sharing glyph, then its symbols
+     *   U+2191 0156             code point written in hex
+     *   fallback 6              glyph for characters font has no glyph for
+     *
+     * Symbol is a list of lit segment numbers 0..7 as in seven_segment_encoder, '-' for blank one or 0xHH for raw
+     * byte. Without fallback unsupported characters are reported as before.
+     */
+    class glyph_font {
+    public:
+        static constexpr uint32_t replacement_character = 0xFFFD;
+
+        // Built-in glyphs only
+        glyph_font();
+        // Built-in glyphs with those of font file added or replaced
+        explicit glyph_font(const std::string& path);
+
+        static std::shared_ptr<const glyph_font> builtin();
+        // Code point at position and its length in bytes, malformed sequence is one replacement character
+        static uint32_t decode(const char* text, const size_t size, const size_t position, size_t& length);
+        // Symbols in font file format, such as "0126 -"
+        static seven_segment_glyph parse_glyph(const std::string& symbols);
+
+        // Glyph of code point, fallback one or one with no symbols if font does not cover it
+        const seven_segment_glyph& glyph(const uint32_t code_point) const;
+        void set_glyph(const uint32_t code_point, const seven_segment_glyph& glyph);
+        void set_fallback(const seven_segment_glyph& glyph);
+        bool has_fallback() const;
+
+        // Same as seven_segment_encoder, positions are byte offsets of code points
+        encode_status measure(const std::string_view& text) const;
+        encode_status encode(const std::string_view& text, uint8_t* buffer, const size_t capacity) const;
+
+    private:
+        static constexpr uint32_t block_bits = 8;
+        static constexpr uint32_t code_points = 0x110000;
+        using block = std::array<uint16_t, 1u << block_bits>;
+
+        void load(const char* text, const size_t size, const std::string& path);
+
+        // Block of every 256 code points, all unsupported ones share block 0
+        std::vector<uint16_t> pages;
+        std::vector<block> blocks;
+        // Glyph 0 is the fallback one, empty unless set
+        std::vector<seven_segment_glyph> glyphs;
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_GLYPH_FONT_H
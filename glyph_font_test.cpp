@@ -0,0 +1,115 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <unistd.h>
+#include "glyph_font.h"
+
+using namespace fpga_ticker_client;
+
+namespace {
+    struct decoded {
+        std::string text;
+        uint32_t code_point;
+        size_t length;
+    };
+
+    int check_decode()
+    {
+        const std::vector<decoded> expected = {
+            { "a", 'a', 1 },
+            { "\xD0\x96", 0x416, 2 },
+            { "\xE2\x86\x91", 0x2191, 3 },
+            { "\xF0\x9F\x98\x80", 0x1F600, 4 },
+            // Stray continuation byte, overlong form, surrogate and sequence cut short are one replacement each
+            { "\x80", glyph_font::replacement_character, 1 },
+            { "\xC0\x80", glyph_font::replacement_character, 1 },
+            { "\xED\xA0\x80", glyph_font::replacement_character, 1 },
+            { "\xE2\x86", glyph_font::replacement_character, 1 },
+            { "\xD0" "a", glyph_font::replacement_character, 1 }
+        };
+        for (const decoded& sequence : expected) {
+            size_t length = 0;
+            const uint32_t code_point = glyph_font::decode(sequence.text.data(), sequence.text.size(), 0, length);
+            if ((code_point != sequence.code_point) || (length != sequence.length)) {
+                std::cerr << "Sequence of " << sequence.text.size() << " bytes decoded to U+" << std::hex
+                    << code_point << " of " << std::dec << length << " bytes" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        return EXIT_SUCCESS;
+    }
+
+    int check_builtin()
+    {
+        const std::shared_ptr<const glyph_font> font = glyph_font::builtin();
+        if (font->has_fallback() || (font->glyph(0x416).length != 0)) {
+            std::cerr << "Built-in font covers more than ASCII glyphs" << std::endl;
+            return EXIT_FAILURE;
+        }
+        // Positions are byte offsets, not character numbers
+        const encode_status status = font->measure("ab\xD0\x96z");
+        if (status.ok() || (status.unsupported_position != 2) || (status.size != 2)) {
+            std::cerr << "Character without glyph was not reported at its byte offset" << std::endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    int check_font_file(const std::string& path)
+    {
+        const glyph_font font(path);
+        const seven_segment_glyph& zhe = font.glyph(0x416);
+        if ((zhe.length != 2) || (zhe.symbols[0] != 0xC9) || (zhe.symbols[1] != 0xC6)
+            || (font.glyph(0x436).length != 2)) {
+            std::cerr << "Glyph shared by both cases was not loaded" << std::endl;
+            return EXIT_FAILURE;
+        }
+        if ((font.glyph(0x2191).length != 1) || (font.glyph(0x2191).symbols[0] != 0xDE)) {
+            std::cerr << "Glyph of hex code point was not loaded" << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (font.glyph('a').symbols[0] != glyph_font::builtin()->glyph('a').symbols[0]) {
+            std::cerr << "Font file replaced built-in glyph it does not list" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (!font.has_fallback() || (font.glyph('!').length != 1) || (font.glyph('!').symbols[0] != 0xBF)) {
+            std::cerr << "Fallback glyph was not used for character without glyph" << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::vector<uint8_t> buffer(8, 0);
+        const encode_status status = font.encode("\xD0\x96!\xE2\x86\x91", buffer.data(), buffer.size());
+        if (!status.ok() || (status.size != 4) || (buffer[2] != 0xBF) || (buffer[3] != 0xDE)) {
+            std::cerr << "Text with fallback character was not encoded" << std::endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+}
+
+int main()
+{
+    if ((check_decode() != EXIT_SUCCESS) || (check_builtin() != EXIT_SUCCESS)) {
+        return EXIT_FAILURE;
+    }
+
+    char path[] = "/tmp/glyph_font_test.XXXXXX";
+    const int file = mkstemp(path);
+    const std::string font_text = "# Cyrillic\n\xD0\x96\xD0\xB6 1245 0345\nU+2191 05\nfallback 6\n";
+    if ((file == -1) || (write(file, font_text.data(), font_text.size()) != static_cast<ssize_t>(font_text.size()))) {
+        std::cerr << "Error writing font file" << std::endl;
+        return EXIT_FAILURE;
+    }
+    close(file);
+
+    int result;
+    try {
+        result = check_font_file(path);
+    } catch (const std::exception& e) {
+        std::cerr << "Error loading font file: " << e.what() << std::endl;
+        result = EXIT_FAILURE;
+    }
+    unlink(path);
+    return result;
+}
@@ -0,0 +1,50 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_LATEST_VALUE_SLOT_H
+#define DDS_FPGA_TICKER_CLIENT_LATEST_VALUE_SLOT_H
+
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace fpga_ticker_client {
+    /*
+     * Wait-free single-producer single-consumer slot keeping only the newest value (triple buffering).
+     * Producer never blocks or allocates however slow the consumer is, consumer sees each value at most once.
+     */
+    template <typename T>
+    class latest_value_slot {
+    public:
+        latest_value_slot() : buffers(), middle(1), back(0), front(2)
+        { }
+        latest_value_slot(const latest_value_slot&) = delete;
+        latest_value_slot& operator=(const latest_value_slot&) = delete;
+
+        // Producer side
+        void publish(const T& value)
+        {
+            buffers[back] = value;
+            back = middle.exchange(static_cast<uint8_t>(back | fresh_flag), std::memory_order_acq_rel) & index_mask;
+        }
+
+        // Consumer side, returns false when nothing was published since previous call
+        bool take(T& value)
+        {
+            if ((middle.load(std::memory_order_relaxed) & fresh_flag) == 0) {
+                return false;
+            }
+            front = middle.exchange(front, std::memory_order_acq_rel) & index_mask;
+            value = buffers[front];
+            return true;
+        }
+
+    private:
+        static constexpr uint8_t index_mask = 0x03, fresh_flag = 0x04;
+
+        std::array<T, 3> buffers;
+        std::atomic<uint8_t> middle;
+        uint8_t back, front;
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_LATEST_VALUE_SLOT_H
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <thread>
+#include <cstdlib>
+#include <cstdint>
+#include "latest_value_slot.h"
+
+using namespace fpga_ticker_client;
+
+namespace {
+    // Two copies of the same number, differing only when a value was torn by concurrent publish
+    struct sample {
+        uint64_t value = 0;
+        uint64_t check = 0;
+    };
+
+    const uint64_t published_values = 1000000;
+
+    int check_latest_only()
+    {
+        latest_value_slot<sample> slot;
+        sample taken;
+        if (slot.take(taken)) {
+            std::cerr << "Value taken before any was published" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        for (uint64_t value = 1; value <= 3; ++value) {
+            slot.publish({ value, value });
+        }
+        if (!slot.take(taken) || (taken.value != 3)) {
+            std::cerr << "Newest value was not taken" << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (slot.take(taken)) {
+            std::cerr << "Value was taken twice" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        slot.publish({ 4, 4 });
+        if (!slot.take(taken) || (taken.value != 4)) {
+            std::cerr << "Value published after take was lost" << std::endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    int check_concurrent()
+    {
+        latest_value_slot<sample> slot;
+        std::thread producer([&slot] {
+            for (uint64_t value = 1; value <= published_values; ++value) {
+                slot.publish({ value, value });
+            }
+        });
+
+        uint64_t last = 0;
+        int result = EXIT_SUCCESS;
+        while (last != published_values) {
+            sample taken;
+            if (!slot.take(taken)) {
+                continue;
+            }
+            if (taken.value != taken.check) {
+                std::cerr << "Torn value " << taken.value << "/" << taken.check << std::endl;
+                result = EXIT_FAILURE;
+                break;
+            }
+            if (taken.value <= last) {
+                std::cerr << "Value " << taken.value << " taken after " << last << std::endl;
+                result = EXIT_FAILURE;
+                break;
+            }
+            last = taken.value;
+        }
+        producer.join();
+        return result;
+    }
+}
+
+int main()
+{
+    if ((check_latest_only() != EXIT_SUCCESS) || (check_concurrent() != EXIT_SUCCESS)) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
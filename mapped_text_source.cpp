@@ -0,0 +1,175 @@
+#include "mapped_text_source.h"
+#include <stdexcept>
+
+#ifdef __unix__
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace fpga_ticker_client;
+
+namespace {
+    // Release boundaries are kept aligned to the largest common page size
+    const size_t page_size = 64 * 1024;
+    // Shown for characters font has neither glyph nor fallback for, lights no segments
+    const seven_segment_glyph blank_glyph = { { 0xFF }, 1 };
+}
+
+#ifdef __unix__
+mapped_text_source::mapped_text_source(const std::string& path, const std::shared_ptr<const glyph_font>& font)
+    : font(font), text(nullptr), size(0), cursor(0), released(0), position(0), current_glyph(nullptr),
+    glyph_symbol(0)
+{
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file == -1) {
+        throw std::runtime_error("Error opening " + path + ": " + std::to_string(errno));
+    }
+
+    struct stat file_status = {};
+    if (fstat(file, &file_status) == -1) {
+        const int error = errno;
+        close(file);
+        throw std::runtime_error("Error reading size of " + path + ": " + std::to_string(error));
+    }
+    size = static_cast<size_t>(file_status.st_size);
+    if (size == 0) {
+        close(file);
+        throw std::runtime_error("Text to send is empty");
+    }
+
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    const int error = errno;
+    close(file);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Error mapping " + path + ": " + std::to_string(error));
+    }
+    text = static_cast<const char*>(mapping);
+    madvise(mapping, size, MADV_SEQUENTIAL);
+}
+
+mapped_text_source::~mapped_text_source()
+{
+    munmap(const_cast<char*>(text), size);
+}
+
+void mapped_text_source::release_pages(const size_t begin, const size_t end)
+{
+    madvise(const_cast<char*>(text) + begin, end - begin, MADV_DONTNEED);
+}
+
+#elif defined (_WIN32) || defined(_WIN64)
+mapped_text_source::mapped_text_source(const std::string& path, const std::shared_ptr<const glyph_font>& font)
+    : font(font), text(nullptr), size(0), cursor(0), released(0), position(0), current_glyph(nullptr),
+    glyph_symbol(0), file(INVALID_HANDLE_VALUE), mapping(NULL)
+{
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Error opening " + path + ": " + std::to_string(GetLastError()));
+    }
+
+    LARGE_INTEGER file_size;
+    if (GetFileSizeEx(file, &file_size) == FALSE) {
+        const DWORD error = GetLastError();
+        CloseHandle(file);
+        throw std::runtime_error("Error reading size of " + path + ": " + std::to_string(error));
+    }
+    size = static_cast<size_t>(file_size.QuadPart);
+    if (size == 0) {
+        CloseHandle(file);
+        throw std::runtime_error("Text to send is empty");
+    }
+
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    text = (mapping != NULL) ? static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+    if (text == nullptr) {
+        const DWORD error = GetLastError();
+        if (mapping != NULL) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        throw std::runtime_error("Error mapping " + path + ": " + std::to_string(error));
+    }
+}
+
+mapped_text_source::~mapped_text_source()
+{
+    UnmapViewOfFile(text);
+    CloseHandle(mapping);
+    CloseHandle(file);
+}
+
+void mapped_text_source::release_pages(const size_t begin, const size_t end)
+{
+    // Unlocking pages that are not locked removes them from working set
+    VirtualUnlock(const_cast<char*>(text) + begin, end - begin);
+}
+
+#endif
+
+void mapped_text_source::release_consumed()
+{
+    // Small files stay resident, there is nothing to gain from releasing them on every pass
+    if (size < release_window) {
+        return;
+    }
+    if (cursor == 0) {
+        release_pages(released, size);
+        released = 0;
+    } else if (cursor - released >= release_window) {
+        const size_t release_end = cursor - cursor % page_size;
+        release_pages(released, release_end);
+        released = release_end;
+    }
+}
+
+uint8_t mapped_text_source::next_symbol()
+{
+    if (current_glyph == nullptr) {
+        size_t length;
+        const uint32_t code_point = glyph_font::decode(text, size, cursor, length);
+        const bool is_whitespace = (code_point == '\n') || (code_point == '\r') || (code_point == '\t');
+        current_glyph = &font->glyph(is_whitespace ? ' ' : code_point);
+        if (current_glyph->length == 0) {
+            // Large file is not rejected halfway through for a single stray character
+            current_glyph = &blank_glyph;
+        }
+        position = cursor;
+        glyph_symbol = 0;
+        cursor = (cursor + length == size) ? 0 : cursor + length;
+        release_consumed();
+    }
+
+    const uint8_t symbol = current_glyph->symbols[glyph_symbol++];
+    if (glyph_symbol == current_glyph->length) {
+        current_glyph = nullptr;
+    }
+    return symbol;
+}
+
+void mapped_text_source::read(uint8_t* symbols, const size_t count)
+{
+    for (size_t symbol_no = 0; symbol_no < count; ++symbol_no) {
+        symbols[symbol_no] = next_symbol();
+    }
+}
+
+void mapped_text_source::skip(size_t count)
+{
+    while (count-- > 0) {
+        next_symbol();
+    }
+}
+
+size_t mapped_text_source::get_position() const
+{
+    return position;
+}
+
+size_t mapped_text_source::get_size() const
+{
+    return size;
+}
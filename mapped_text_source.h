@@ -0,0 +1,64 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_MAPPED_TEXT_SOURCE_H
+#define DDS_FPGA_TICKER_CLIENT_MAPPED_TEXT_SOURCE_H
+
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "glyph_font.h"
+
+#if defined (_WIN32) || defined(_WIN64)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#endif
+
+namespace fpga_ticker_client {
+    /*
+     * Encodes memory-mapped text file lazily, symbol by symbol, starting over from the beginning after the last
+     * character just like a frame sent cyclically. Pages behind the cursor are released as it advances, so resident
+     * memory stays bounded by release_window however long the file is.
+     * Text is UTF-8. Line breaks and tabs are shown as spaces, other characters font has no glyph for as its fallback
+     * glyph or, without one, blank.
+     */
+    class mapped_text_source {
+    public:
+        static constexpr size_t release_window = 1 << 20;
+
+        explicit mapped_text_source(const std::string& path,
+            const std::shared_ptr<const glyph_font>& font = glyph_font::builtin());
+        ~mapped_text_source();
+        mapped_text_source(const mapped_text_source&) = delete;
+        mapped_text_source& operator=(const mapped_text_source&) = delete;
+
+        // Fills exactly count symbols, wrapping around at the end of file
+        void read(uint8_t* symbols, const size_t count);
+        void skip(size_t count);
+
+        // Offset of character last symbol was taken from
+        size_t get_position() const;
+        size_t get_size() const;
+
+    private:
+        uint8_t next_symbol();
+        void release_consumed();
+        void release_pages(const size_t begin, const size_t end);
+
+        const std::shared_ptr<const glyph_font> font;
+        const char* text;
+        size_t size;
+        size_t cursor;
+        size_t released;
+        size_t position;
+        const seven_segment_glyph* current_glyph;
+        uint8_t glyph_symbol;
+#if defined (_WIN32) || defined(_WIN64)
+        HANDLE file, mapping;
+#endif
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_MAPPED_TEXT_SOURCE_H
@@ -0,0 +1,52 @@
+#include "metrics_dumper.h"
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+using namespace fpga_ticker_client;
+
+metrics_dumper::metrics_dumper(const std::string& path, const std::chrono::milliseconds& interval,
+    const std::function<std::string()>& source)
+    : path(path), interval(interval), source(source), should_dump(true)
+{
+    if (interval.count() <= 0) {
+        throw std::invalid_argument("Metrics dump interval must be positive");
+    }
+    dumping_thread = std::thread(&metrics_dumper::dumping_routine, this);
+}
+
+metrics_dumper::~metrics_dumper()
+{
+    {
+        std::lock_guard<std::mutex> lock(dump_mx);
+        should_dump = false;
+    }
+    dump_cv.notify_all();
+    dumping_thread.join();
+    dump();
+}
+
+void metrics_dumper::dump() const
+{
+    const std::string temporary_path = path + ".tmp";
+    {
+        std::ofstream output(temporary_path, std::ios::trunc);
+        output << source();
+        if (!output) {
+            return;
+        }
+    }
+    if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+        std::remove(temporary_path.c_str());
+    }
+}
+
+void metrics_dumper::dumping_routine()
+{
+    std::unique_lock<std::mutex> lock(dump_mx);
+    while (!dump_cv.wait_for(lock, interval, [this] { return !should_dump; })) {
+        lock.unlock();
+        dump();
+        lock.lock();
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_METRICS_DUMPER_H
+#define DDS_FPGA_TICKER_CLIENT_METRICS_DUMPER_H
+
+
+#include <string>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace fpga_ticker_client {
+    /*
+     * Periodically replaces file with text returned by source, so that scrapers never see partial output.
+     * Last dump is written once more on destruction.
+     */
+    class metrics_dumper {
+    public:
+        metrics_dumper(const std::string& path, const std::chrono::milliseconds& interval,
+            const std::function<std::string()>& source);
+        ~metrics_dumper();
+
+        void dump() const;
+
+    private:
+        void dumping_routine();
+
+        const std::string path;
+        const std::chrono::milliseconds interval;
+        const std::function<std::string()> source;
+        bool should_dump;
+        std::mutex dump_mx;
+        std::condition_variable dump_cv;
+        std::thread dumping_thread;
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_METRICS_DUMPER_H
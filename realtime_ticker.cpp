@@ -0,0 +1,308 @@
+#include "realtime_ticker.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+using namespace fpga_ticker_client;
+
+std::string jitter_statistics::to_string() const
+{
+    const auto to_us = [](const std::chrono::nanoseconds& value) {
+        return std::chrono::duration<double, std::micro>(value).count();
+    };
+
+    std::ostringstream result;
+    result << ticks << " ticks, " << missed_ticks << " missed, lateness min " << to_us(min_lateness)
+        << " us, max " << to_us(max_lateness) << " us, mean " << to_us(mean_lateness)
+        << " us, stddev " << to_us(lateness_stddev) << " us";
+    return result.str();
+}
+
+jitter_statistics realtime_ticker::get_statistics() const
+{
+    jitter_statistics statistics;
+    statistics.ticks = recorded_ticks;
+    statistics.missed_ticks = missed_ticks;
+    if (recorded_ticks != 0) {
+        const double mean = lateness_sum / recorded_ticks;
+        const double variance = std::max(lateness_square_sum / recorded_ticks - mean * mean, 0.0);
+        statistics.min_lateness = std::chrono::nanoseconds(min_lateness_ns);
+        statistics.max_lateness = std::chrono::nanoseconds(max_lateness_ns);
+        statistics.mean_lateness = std::chrono::nanoseconds(std::llround(mean));
+        statistics.lateness_stddev = std::chrono::nanoseconds(std::llround(std::sqrt(variance)));
+    }
+    return statistics;
+}
+
+std::chrono::nanoseconds realtime_ticker::get_last_lateness() const
+{
+    return std::chrono::nanoseconds(last_lateness_ns);
+}
+
+void realtime_ticker::record_lateness(const std::int64_t lateness_ns, const size_t elapsed_ticks)
+{
+    last_lateness_ns = lateness_ns;
+    if ((recorded_ticks == 0) || (lateness_ns < min_lateness_ns)) {
+        min_lateness_ns = lateness_ns;
+    }
+    if ((recorded_ticks == 0) || (lateness_ns > max_lateness_ns)) {
+        max_lateness_ns = lateness_ns;
+    }
+    ++recorded_ticks;
+    missed_ticks += elapsed_ticks - 1;
+    lateness_sum += static_cast<double>(lateness_ns);
+    lateness_square_sum += static_cast<double>(lateness_ns) * static_cast<double>(lateness_ns);
+}
+
+#ifdef __linux__
+#include <cerrno>
+#include <ctime>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace {
+    std::int64_t monotonic_now_ns()
+    {
+        struct timespec now = {};
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return static_cast<std::int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+    }
+
+    struct timespec to_timespec(const std::int64_t ns)
+    {
+        struct timespec result = {};
+        result.tv_sec = static_cast<time_t>(ns / 1000000000);
+        result.tv_nsec = static_cast<long>(ns % 1000000000);
+        return result;
+    }
+}
+
+realtime_ticker::realtime_ticker(const realtime_options& options)
+    : options(options), cancelled(false), timer(-1), cancel_event(-1), start_ns(0), ticks(0),
+    recorded_ticks(0), missed_ticks(0), min_lateness_ns(0), max_lateness_ns(0), last_lateness_ns(0),
+    lateness_sum(0), lateness_square_sum(0)
+{
+    if (options.period <= std::chrono::microseconds::zero()) {
+        throw std::invalid_argument("Realtime period must be positive");
+    }
+
+    if (options.use_timerfd) {
+        timer = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        cancel_event = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if ((timer == -1) || (cancel_event == -1)) {
+            const int error = errno;
+            if (timer != -1) {
+                close(timer);
+            }
+            if (cancel_event != -1) {
+                close(cancel_event);
+            }
+            throw std::runtime_error("Error creating realtime timer: " + std::to_string(error));
+        }
+    }
+}
+
+struct realtime_ticker::saved_thread_settings {
+    bool memory_locked = false;
+    bool affinity_changed = false;
+    cpu_set_t cpus;
+    bool scheduling_changed = false;
+    int policy = SCHED_OTHER;
+    struct sched_param parameters = {};
+};
+
+realtime_ticker::~realtime_ticker()
+{
+    try {
+        restore_thread_settings();
+    } catch (const std::exception&) { }
+    if (timer != -1) {
+        close(timer);
+    }
+    if (cancel_event != -1) {
+        close(cancel_event);
+    }
+}
+
+void realtime_ticker::apply_thread_settings()
+{
+    restore_thread_settings();
+    // Whatever was applied before a failure is still restored
+    saved_settings = std::make_unique<saved_thread_settings>();
+    saved_thread_settings& saved = *saved_settings;
+
+    if (options.lock_memory) {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) == -1) {
+            throw std::runtime_error("Error locking memory: " + std::to_string(errno));
+        }
+        saved.memory_locked = true;
+    }
+
+    if (options.cpu >= 0) {
+        int error = pthread_getaffinity_np(pthread_self(), sizeof(saved.cpus), &saved.cpus);
+        if (error == 0) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(options.cpu, &cpus);
+            error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        }
+        if (error != 0) {
+            throw std::runtime_error("Error pinning thread to CPU " + std::to_string(options.cpu) + ": "
+                + std::to_string(error));
+        }
+        saved.affinity_changed = true;
+    }
+
+    if (options.fifo_priority > 0) {
+        int error = pthread_getschedparam(pthread_self(), &saved.policy, &saved.parameters);
+        if (error == 0) {
+            struct sched_param parameters = {};
+            parameters.sched_priority = options.fifo_priority;
+            error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters);
+        }
+        if (error != 0) {
+            throw std::runtime_error("Error setting SCHED_FIFO priority: " + std::to_string(error));
+        }
+        saved.scheduling_changed = true;
+    }
+}
+
+void realtime_ticker::restore_thread_settings()
+{
+    if (!saved_settings) {
+        return;
+    }
+    const std::unique_ptr<saved_thread_settings> saved = std::move(saved_settings);
+
+    // Everything is put back even if one of the steps fails, the first failure is reported
+    int scheduling_error = 0, affinity_error = 0, memory_error = 0;
+    if (saved->scheduling_changed) {
+        scheduling_error = pthread_setschedparam(pthread_self(), saved->policy, &saved->parameters);
+    }
+    if (saved->affinity_changed) {
+        affinity_error = pthread_setaffinity_np(pthread_self(), sizeof(saved->cpus), &saved->cpus);
+    }
+    if (saved->memory_locked && (munlockall() == -1)) {
+        memory_error = errno;
+    }
+
+    if (scheduling_error != 0) {
+        throw std::runtime_error("Error restoring thread scheduling: " + std::to_string(scheduling_error));
+    }
+    if (affinity_error != 0) {
+        throw std::runtime_error("Error restoring thread affinity: " + std::to_string(affinity_error));
+    }
+    if (memory_error != 0) {
+        throw std::runtime_error("Error unlocking memory: " + std::to_string(memory_error));
+    }
+}
+
+void realtime_ticker::start()
+{
+    start_ns = monotonic_now_ns();
+    ticks = 0;
+    if (options.use_timerfd) {
+        const std::int64_t period_ns = std::chrono::nanoseconds(options.period).count();
+        struct itimerspec timer_settings = {};
+        timer_settings.it_interval = to_timespec(period_ns);
+        timer_settings.it_value = to_timespec(start_ns + period_ns);
+        if (timerfd_settime(timer, TFD_TIMER_ABSTIME, &timer_settings, nullptr) == -1) {
+            throw std::runtime_error("Error starting realtime timer: " + std::to_string(errno));
+        }
+    }
+}
+
+size_t realtime_ticker::wait()
+{
+    const std::int64_t period_ns = std::chrono::nanoseconds(options.period).count();
+    size_t elapsed_ticks = 0;
+
+    if (options.use_timerfd) {
+        struct pollfd descriptors[2] = { { timer, POLLIN, 0 }, { cancel_event, POLLIN, 0 } };
+        while (elapsed_ticks == 0) {
+            if (cancelled) {
+                return 0;
+            }
+            if (poll(descriptors, 2, -1) == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error("Error waiting for realtime timer: " + std::to_string(errno));
+            }
+            if (descriptors[1].revents != 0) {
+                return 0;
+            }
+
+            std::uint64_t expirations;
+            if (read(timer, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+                elapsed_ticks = static_cast<size_t>(expirations);
+            } else if ((errno != EAGAIN) && (errno != EINTR)) {
+                throw std::runtime_error("Error reading realtime timer: " + std::to_string(errno));
+            }
+        }
+    } else {
+        const struct timespec deadline = to_timespec(start_ns + (ticks + 1) * period_ns);
+        int error;
+        while ((error = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr)) == EINTR) { }
+        if (error != 0) {
+            throw std::runtime_error("Error sleeping until deadline: " + std::to_string(error));
+        }
+        if (cancelled) {
+            return 0;
+        }
+        elapsed_ticks = static_cast<size_t>((monotonic_now_ns() - start_ns) / period_ns - ticks);
+    }
+
+    ticks += static_cast<std::int64_t>(elapsed_ticks);
+    record_lateness(monotonic_now_ns() - (start_ns + ticks * period_ns), elapsed_ticks);
+    return elapsed_ticks;
+}
+
+void realtime_ticker::cancel()
+{
+    cancelled = true;
+    if (cancel_event != -1) {
+        const std::uint64_t increment = 1;
+        (void)!write(cancel_event, &increment, sizeof(increment));
+    }
+}
+
+#else
+realtime_ticker::realtime_ticker(const realtime_options& options)
+    : options(options), cancelled(false), timer(-1), cancel_event(-1), start_ns(0), ticks(0),
+    recorded_ticks(0), missed_ticks(0), min_lateness_ns(0), max_lateness_ns(0), last_lateness_ns(0),
+    lateness_sum(0), lateness_square_sum(0)
+{
+    throw std::runtime_error("Realtime mode is only supported on Linux");
+}
+
+struct realtime_ticker::saved_thread_settings { };
+
+realtime_ticker::~realtime_ticker() = default;
+
+void realtime_ticker::apply_thread_settings()
+{ }
+
+void realtime_ticker::restore_thread_settings()
+{ }
+
+void realtime_ticker::start()
+{ }
+
+size_t realtime_ticker::wait()
+{
+    return 0;
+}
+
+void realtime_ticker::cancel()
+{
+    cancelled = true;
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_REALTIME_TICKER_H
+#define DDS_FPGA_TICKER_CLIENT_REALTIME_TICKER_H
+
+
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace fpga_ticker_client {
+    struct realtime_options {
+        std::chrono::microseconds period = std::chrono::microseconds(1000);
+        bool use_timerfd = true;    // otherwise clock_nanosleep(TIMER_ABSTIME), cancelled at tick boundaries only
+        int fifo_priority = 0;      // SCHED_FIFO priority, 0 keeps default scheduler
+        bool lock_memory = false;
+        int cpu = -1;               // CPU to pin sending thread to, -1 keeps default affinity
+    };
+
+    struct jitter_statistics {
+        size_t ticks = 0;
+        size_t missed_ticks = 0;
+        std::chrono::nanoseconds min_lateness = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds max_lateness = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds mean_lateness = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds lateness_stddev = std::chrono::nanoseconds::zero();
+
+        std::string to_string() const;
+    };
+
+    class realtime_ticker {
+    public:
+        explicit realtime_ticker(const realtime_options& options);
+        ~realtime_ticker();
+        realtime_ticker(const realtime_ticker&) = delete;
+        realtime_ticker& operator=(const realtime_ticker&) = delete;
+
+        // Applies priority, memory locking and affinity from options to calling thread, which must be the one
+        // that destroys the ticker: previous settings are restored then or by restore_thread_settings()
+        void apply_thread_settings();
+        void restore_thread_settings();
+
+        void start();
+        // Returns number of ticks elapsed since previous call, or 0 if cancelled
+        size_t wait();
+        void cancel();
+
+        jitter_statistics get_statistics() const;
+        std::chrono::nanoseconds get_last_lateness() const;
+
+    private:
+        struct saved_thread_settings;
+
+        void record_lateness(const std::int64_t lateness_ns, const size_t elapsed_ticks);
+
+        const realtime_options options;
+        std::unique_ptr<saved_thread_settings> saved_settings;
+        std::atomic_bool cancelled;
+        int timer;
+        int cancel_event;
+        std::int64_t start_ns, ticks;
+        size_t recorded_ticks, missed_ticks;
+        std::int64_t min_lateness_ns, max_lateness_ns, last_lateness_ns;
+        double lateness_sum, lateness_square_sum;
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_REALTIME_TICKER_H
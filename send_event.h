@@ -21,8 +21,11 @@ namespace fpga_ticker_client {
     };
 }
 
+wxDEFINE_EVENT(SEND_STARTED_EVENT, fpga_ticker_client::send_event);
+wxDEFINE_EVENT(COMMAND_ERROR_EVENT, fpga_ticker_client::send_event);
 wxDEFINE_EVENT(DEVICE_OPEN_ERROR_EVENT, fpga_ticker_client::send_event);
 wxDEFINE_EVENT(DATA_SEND_ERROR_EVENT, fpga_ticker_client::send_event);
+wxDEFINE_EVENT(DEVICE_LOST_EVENT, fpga_ticker_client::send_event);
 wxDEFINE_EVENT(SEND_STOPPED_EVENT, fpga_ticker_client::send_event);
 
 
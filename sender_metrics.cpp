@@ -0,0 +1,178 @@
+#include "sender_metrics.h"
+#include <sstream>
+
+using namespace fpga_ticker_client;
+
+namespace {
+    void increment(std::atomic<uint64_t>& counter, const uint64_t value)
+    {
+        // Single writer: plain load and store avoid locked read-modify-write instructions
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    size_t bucket_of(const uint64_t value_ns)
+    {
+        size_t bucket = 0;
+        while ((bucket + 1 < histogram_snapshot::bucket_count) && (value_ns >= (1ull << bucket))) {
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    std::string label_set(const std::string& labels)
+    {
+        return labels.empty() ? "" : "{" + labels + "}";
+    }
+
+    void write_histogram(std::ostringstream& result, const std::string& name, const std::string& help,
+        const histogram_snapshot& histogram, const std::string& labels)
+    {
+        const std::string separator = labels.empty() ? "" : ",";
+        result << "# HELP " << name << ' ' << help << '\n' << "# TYPE " << name << " histogram\n";
+        uint64_t cumulative = 0;
+        for (size_t bucket = 0; bucket + 1 < histogram_snapshot::bucket_count; ++bucket) {
+            cumulative += histogram.buckets[bucket];
+            result << name << "_bucket{" << labels << separator << "le=\""
+                << static_cast<double>(histogram_snapshot::bucket_upper_bound_ns(bucket)) / 1e9 << "\"} "
+                << cumulative << '\n';
+        }
+        result << name << "_bucket{" << labels << separator << "le=\"+Inf\"} " << histogram.count << '\n'
+            << name << "_sum" << label_set(labels) << ' ' << static_cast<double>(histogram.sum_ns) / 1e9 << '\n'
+            << name << "_count" << label_set(labels) << ' ' << histogram.count << '\n';
+    }
+
+    void write_counter(std::ostringstream& result, const std::string& name, const std::string& help,
+        const uint64_t value, const std::string& labels)
+    {
+        result << "# HELP " << name << ' ' << help << '\n' << "# TYPE " << name << " counter\n"
+            << name << label_set(labels) << ' ' << value << '\n';
+    }
+}
+
+uint64_t histogram_snapshot::bucket_upper_bound_ns(const size_t bucket)
+{
+    return 1ull << bucket;
+}
+
+std::chrono::nanoseconds histogram_snapshot::mean() const
+{
+    return std::chrono::nanoseconds((count != 0) ? sum_ns / count : 0);
+}
+
+std::chrono::nanoseconds histogram_snapshot::quantile(const double fraction) const
+{
+    const auto target = static_cast<uint64_t>(fraction * static_cast<double>(count));
+    uint64_t cumulative = 0;
+    for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+        cumulative += buckets[bucket];
+        if ((cumulative > target) || ((cumulative == count) && (count != 0))) {
+            return std::chrono::nanoseconds(bucket_upper_bound_ns(bucket));
+        }
+    }
+    return std::chrono::nanoseconds::zero();
+}
+
+std::string metrics_snapshot::to_string() const
+{
+    const auto to_us = [](const std::chrono::nanoseconds& value) {
+        return std::chrono::duration<double, std::micro>(value).count();
+    };
+
+    std::ostringstream result;
+    result << bytes_sent << " bytes sent in " << write_syscalls << " writes, " << loop_iterations << " ticks, "
+        << missed_deadlines << " missed deadlines, " << dropped_ticks << " dropped\n"
+        << "write latency mean " << to_us(write_latency.mean()) << " us, p99 < "
+        << to_us(write_latency.quantile(0.99)) << " us\n"
+        << "tick lateness mean " << to_us(tick_lateness.mean()) << " us, p99 < "
+        << to_us(tick_lateness.quantile(0.99)) << " us";
+    return result.str();
+}
+
+std::string metrics_snapshot::to_prometheus(const std::string& labels) const
+{
+    std::ostringstream result;
+    write_counter(result, "ticker_bytes_sent_total", "Bytes written to device.", bytes_sent, labels);
+    write_counter(result, "ticker_write_syscalls_total", "Write system calls issued.", write_syscalls, labels);
+    write_counter(result, "ticker_loop_iterations_total", "Sending loop iterations.", loop_iterations, labels);
+    write_counter(result, "ticker_missed_deadlines_total", "Tick deadlines passed without sending.",
+        missed_deadlines, labels);
+    write_counter(result, "ticker_dropped_ticks_total", "Ticks dropped because device fell behind.",
+        dropped_ticks, labels);
+    write_histogram(result, "ticker_write_latency_seconds", "Duration of device write calls.", write_latency,
+        labels);
+    write_histogram(result, "ticker_tick_lateness_seconds", "Wake-up delay after tick deadline.", tick_lateness,
+        labels);
+    return result.str();
+}
+
+latency_histogram::latency_histogram() : count(0), sum_ns(0)
+{
+    for (std::atomic<uint64_t>& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void latency_histogram::record(const std::chrono::nanoseconds& value)
+{
+    const uint64_t value_ns = (value.count() > 0) ? static_cast<uint64_t>(value.count()) : 0;
+    increment(buckets[bucket_of(value_ns)], 1);
+    increment(sum_ns, value_ns);
+    increment(count, 1);
+}
+
+histogram_snapshot latency_histogram::snapshot() const
+{
+    histogram_snapshot result;
+    for (size_t bucket = 0; bucket < histogram_snapshot::bucket_count; ++bucket) {
+        result.buckets[bucket] = buckets[bucket].load(std::memory_order_relaxed);
+    }
+    result.count = count.load(std::memory_order_relaxed);
+    result.sum_ns = sum_ns.load(std::memory_order_relaxed);
+    return result;
+}
+
+sender_metrics::sender_metrics() : bytes_sent(0), loop_iterations(0), missed_deadlines(0), dropped_ticks(0)
+{ }
+
+void sender_metrics::add_bytes_sent(const uint64_t bytes)
+{
+    increment(bytes_sent, bytes);
+}
+
+void sender_metrics::add_loop_iteration()
+{
+    increment(loop_iterations, 1);
+}
+
+void sender_metrics::add_missed_deadlines(const uint64_t deadlines)
+{
+    increment(missed_deadlines, deadlines);
+}
+
+void sender_metrics::add_dropped_tick()
+{
+    increment(dropped_ticks, 1);
+}
+
+void sender_metrics::record_write_latency(const std::chrono::nanoseconds& latency)
+{
+    write_latency.record(latency);
+}
+
+void sender_metrics::record_tick_lateness(const std::chrono::nanoseconds& lateness)
+{
+    tick_lateness.record(lateness);
+}
+
+metrics_snapshot sender_metrics::snapshot(const uint64_t write_syscalls) const
+{
+    metrics_snapshot result;
+    result.bytes_sent = bytes_sent.load(std::memory_order_relaxed);
+    result.write_syscalls = write_syscalls;
+    result.loop_iterations = loop_iterations.load(std::memory_order_relaxed);
+    result.missed_deadlines = missed_deadlines.load(std::memory_order_relaxed);
+    result.dropped_ticks = dropped_ticks.load(std::memory_order_relaxed);
+    result.write_latency = write_latency.snapshot();
+    result.tick_lateness = tick_lateness.snapshot();
+    return result;
+}
@@ -0,0 +1,77 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_SENDER_METRICS_H
+#define DDS_FPGA_TICKER_CLIENT_SENDER_METRICS_H
+
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace fpga_ticker_client {
+    // Power-of-two nanosecond buckets, last one collects everything above 2^30 ns
+    struct histogram_snapshot {
+        static constexpr size_t bucket_count = 32;
+
+        std::array<uint64_t, bucket_count> buckets = { };
+        uint64_t count = 0;
+        uint64_t sum_ns = 0;
+
+        static uint64_t bucket_upper_bound_ns(const size_t bucket);
+        std::chrono::nanoseconds mean() const;
+        // Upper bound of bucket containing given quantile
+        std::chrono::nanoseconds quantile(const double fraction) const;
+    };
+
+    struct metrics_snapshot {
+        uint64_t bytes_sent = 0;
+        uint64_t write_syscalls = 0;
+        uint64_t loop_iterations = 0;
+        uint64_t missed_deadlines = 0;
+        uint64_t dropped_ticks = 0;
+        histogram_snapshot write_latency;
+        histogram_snapshot tick_lateness;
+
+        std::string to_string() const;
+        std::string to_prometheus(const std::string& labels = "") const;
+    };
+
+    class latency_histogram {
+    public:
+        latency_histogram();
+
+        void record(const std::chrono::nanoseconds& value);
+        histogram_snapshot snapshot() const;
+
+    private:
+        std::array<std::atomic<uint64_t>, histogram_snapshot::bucket_count> buckets;
+        std::atomic<uint64_t> count, sum_ns;
+    };
+
+    /*
+     * Written by the sending thread only, with relaxed atomics so that readers never slow it down.
+     * Snapshots taken concurrently may mix values from neighbouring iterations.
+     */
+    class sender_metrics {
+    public:
+        sender_metrics();
+
+        void add_bytes_sent(const uint64_t bytes);
+        void add_loop_iteration();
+        void add_missed_deadlines(const uint64_t deadlines);
+        void add_dropped_tick();
+        void record_write_latency(const std::chrono::nanoseconds& latency);
+        void record_tick_lateness(const std::chrono::nanoseconds& lateness);
+
+        // Syscall count is kept by serial_device and passed in by the owner
+        metrics_snapshot snapshot(const uint64_t write_syscalls) const;
+
+    private:
+        std::atomic<uint64_t> bytes_sent, loop_iterations, missed_deadlines, dropped_ticks;
+        latency_histogram write_latency, tick_lateness;
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_SENDER_METRICS_H
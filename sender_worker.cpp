@@ -0,0 +1,330 @@
+#include "sender_worker.h"
+#include <stdexcept>
+
+using namespace fpga_ticker_client;
+
+sender_worker::sender_worker(const event_handler& on_event, const size_t queue_capacity)
+    : on_event(on_event), queue_capacity(queue_capacity), running(true), has_pending_job(false), job_running(false),
+    job_cancelled(false), job_superseded(false), active_sender(nullptr), last_sender(nullptr),
+    active_watcher(nullptr)
+{
+    if (queue_capacity == 0) {
+        throw std::invalid_argument("Command queue capacity must be positive");
+    }
+    dispatching_thread = std::thread(&sender_worker::dispatching_routine, this);
+    sending_thread = std::thread(&sender_worker::sending_routine, this);
+}
+
+sender_worker::~sender_worker()
+{
+    {
+        std::lock_guard<std::mutex> lock(queue_mx);
+        running = false;
+    }
+    queue_cv.notify_all();
+    dispatching_thread.join();
+
+    {
+        std::unique_lock<std::mutex> lock(job_mx);
+        has_pending_job = false;
+        stop_active(lock);
+    }
+    job_cv.notify_all();
+    sending_thread.join();
+}
+
+bool sender_worker::start(const send_job& job)
+{
+    return post({ command_type::start, job });
+}
+
+bool sender_worker::stop()
+{
+    return post({ command_type::stop, send_job() });
+}
+
+bool sender_worker::update_text(const std::string& text)
+{
+    send_job job;
+    job.text = text;
+    return post({ command_type::update_text, job });
+}
+
+bool sender_worker::set_period(const std::chrono::microseconds& period)
+{
+    send_job job;
+    job.period = period;
+    return post({ command_type::set_period, job });
+}
+
+metrics_snapshot sender_worker::get_metrics() const
+{
+    std::lock_guard<std::mutex> lock(job_mx);
+    const fpga_sender* sender = active_sender ? active_sender : last_sender;
+    return sender ? sender->get_metrics() : metrics_snapshot();
+}
+
+bool sender_worker::poll_progress(ticker_progress& latest)
+{
+    std::lock_guard<std::mutex> lock(job_mx);
+    return (active_sender != nullptr) && active_sender->poll_progress(latest);
+}
+
+bool sender_worker::post(command next)
+{
+    {
+        std::lock_guard<std::mutex> lock(queue_mx);
+        if (!running || (commands.size() >= queue_capacity)) {
+            return false;
+        }
+        commands.push_back(std::move(next));
+    }
+    queue_cv.notify_one();
+    return true;
+}
+
+void sender_worker::stop_active(std::unique_lock<std::mutex>& lock)
+{
+    // Sender and watcher are registered under the same lock after checking job_cancelled, and their stop requests
+    // hold until they are rearmed for the next job, so one request is never lost
+    job_cancelled = true;
+    if (active_sender) {
+        active_sender->stop();
+    }
+    if (active_watcher) {
+        active_watcher->cancel();
+    }
+    job_cv.wait(lock, [this] { return !job_running; });
+}
+
+void sender_worker::dispatching_routine()
+{
+    while (true) {
+        command next;
+        {
+            std::unique_lock<std::mutex> lock(queue_mx);
+            queue_cv.wait(lock, [this] { return !running || !commands.empty(); });
+            if (!running) {
+                return;
+            }
+            next = std::move(commands.front());
+            commands.pop_front();
+        }
+
+        std::unique_lock<std::mutex> lock(job_mx);
+        switch (next.type) {
+        case command_type::start:
+            current_job = next.job;
+            break;
+        case command_type::stop:
+            has_pending_job = false;
+            job_superseded = false;
+            stop_active(lock);
+            continue;
+        case command_type::update_text:
+            try {
+                if (active_sender && !has_pending_job) {
+                    active_sender->update_text(next.job.text);
+                } else if (fpga_sender::transform_text(next.job.text).empty()) {
+                    throw std::runtime_error("Text to send is empty");
+                }
+            } catch (const std::exception& e) {
+                lock.unlock();
+                on_event(event_type::command_error, e.what());
+                continue;
+            }
+            current_job.text = next.job.text;
+            if (has_pending_job) {
+                pending_job.text = next.job.text;
+            }
+            continue;
+        case command_type::set_period: {
+            const std::chrono::microseconds previous_period = current_job.period;
+            current_job.period = next.job.period;
+            if (has_pending_job) {
+                pending_job.period = next.job.period;
+            }
+            // Period of idle worker only applies to the next start of the same job
+            if (!job_running || has_pending_job) {
+                continue;
+            }
+            // Running periodic send keeps its position and switches at its next tick, realtime ticks and sends
+            // with zero period are started again
+            if (active_sender && !current_job.realtime && (previous_period != std::chrono::microseconds::zero())
+                && (next.job.period != std::chrono::microseconds::zero())) {
+                active_sender->set_period(next.job.period);
+                continue;
+            }
+            break;
+        }
+        }
+
+        // Start and period change the running send cannot take replace running job without reporting it stopped
+        job_superseded = true;
+        stop_active(lock);
+        pending_job = current_job;
+        has_pending_job = true;
+        job_cv.notify_all();
+    }
+}
+
+void sender_worker::sending_routine()
+{
+    while (true) {
+        send_job job;
+        {
+            std::unique_lock<std::mutex> lock(job_mx);
+            job_cv.wait(lock, [this] { return !running || has_pending_job; });
+            if (!running) {
+                return;
+            }
+            job = pending_job;
+            has_pending_job = false;
+            job_running = true;
+            job_cancelled = false;
+            job_superseded = false;
+        }
+
+        event_type result = event_type::stopped;
+        std::string message;
+        cached_device* device = open_device(job);
+        fpga_sender* sender = device ? device->sender.get() : nullptr;
+        bool cancelled;
+        {
+            std::lock_guard<std::mutex> lock(job_mx);
+            cancelled = job_cancelled;
+            if (sender && !cancelled) {
+                // Cached sender was stopped at the end of its previous job
+                sender->rearm();
+                active_sender = sender;
+                last_sender = sender;
+            }
+        }
+
+        if (!sender) {
+            result = event_type::device_open_error;
+        } else if (!cancelled) {
+            try {
+                // Checked up front, so that only failures of the device itself are waited out
+                if (fpga_sender::transform_text(job.text).empty()) {
+                    throw std::runtime_error("Text to send is empty");
+                }
+            } catch (const std::exception& e) {
+                result = event_type::send_error;
+                message = e.what();
+            }
+        }
+
+        if (sender && !cancelled && (result != event_type::send_error)) {
+            bool resuming = false;
+            while (true) {
+                on_event(event_type::started, std::to_string(device->device->get_applied_speed()));
+                std::string error;
+                try {
+                    if (resuming) {
+                        sender->resume();
+                    } else if (job.realtime) {
+                        realtime_options options;
+                        options.period = job.period;
+                        message = sender->send_realtime(job.text, options).to_string();
+                    } else {
+                        sender->send(job.text, job.period);
+                    }
+                    break;
+                } catch (const device_lost_error& e) {
+                    error = e.what();
+                } catch (const std::exception& e) {
+                    // Job itself is wrong or cannot run here, such as realtime settings refused; waiting for
+                    // device would only repeat it
+                    result = event_type::send_error;
+                    message = e.what();
+                    break;
+                }
+
+                try {
+                    if (!wait_for_device(job, *device->device, error)) {
+                        // Cached sender must not resume this text for a later job on the same device
+                        sender->discard_interrupted();
+                        break;
+                    }
+                } catch (const std::exception& e) {
+                    sender->discard_interrupted();
+                    result = event_type::send_error;
+                    message = error + ", cannot wait for device: " + e.what();
+                    break;
+                }
+                // Realtime send has no position to resume, it starts over
+                resuming = !job.realtime && sender->can_resume();
+            }
+        }
+
+        // Port may have gone away or was lost while waiting for it, open it again on next start
+        const bool closing = (result == event_type::send_error) || (device && !device->device->is_opened());
+        bool superseded;
+        {
+            std::lock_guard<std::mutex> lock(job_mx);
+            active_sender = nullptr;
+            // Sender is destroyed with its device, metrics must not be read from it any more
+            if (closing && (last_sender == sender)) {
+                last_sender = nullptr;
+            }
+            job_running = false;
+            superseded = job_superseded;
+        }
+        job_cv.notify_all();
+
+        if (closing) {
+            close_device(job);
+        }
+        if (running && !superseded) {
+            on_event(result, message);
+        }
+    }
+}
+
+sender_worker::cached_device* sender_worker::open_device(const send_job& job)
+{
+    const device_key key(job.device_path, job.speed);
+    const auto cached = devices.find(key);
+    if (cached != devices.end()) {
+        return &cached->second;
+    }
+
+    cached_device opened;
+    opened.device = std::make_shared<serial_device>(job.device_path, job.speed);
+    if (!opened.device->is_opened()) {
+        return nullptr;
+    }
+    opened.sender = std::make_unique<fpga_sender>(opened.device);
+    return &devices.emplace(key, std::move(opened)).first->second;
+}
+
+bool sender_worker::wait_for_device(const send_job& job, serial_device& device, const std::string& error)
+{
+    device_watcher watcher(job.device_path);
+    {
+        std::lock_guard<std::mutex> lock(job_mx);
+        if (job_cancelled) {
+            return false;
+        }
+        active_watcher = &watcher;
+    }
+    on_event(event_type::device_lost, error);
+
+    bool reopened = false;
+    try {
+        reopened = watcher.reopen(device);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(job_mx);
+        active_watcher = nullptr;
+        throw;
+    }
+    std::lock_guard<std::mutex> lock(job_mx);
+    active_watcher = nullptr;
+    return reopened && !job_cancelled;
+}
+
+void sender_worker::close_device(const send_job& job)
+{
+    devices.erase({ job.device_path, job.speed });
+}
@@ -0,0 +1,110 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_SENDER_WORKER_H
+#define DDS_FPGA_TICKER_CLIENT_SENDER_WORKER_H
+
+
+#include <map>
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <utility>
+#include <functional>
+#include <condition_variable>
+#include "fpga_sender.h"
+#include "serial_device.h"
+#include "device_watcher.h"
+
+namespace fpga_ticker_client {
+    struct send_job {
+        std::string device_path;
+        uint32_t speed = 0;
+        std::string text;
+        std::chrono::microseconds period = std::chrono::microseconds::zero();
+        bool realtime = false;
+    };
+
+    /*
+     * Long-lived sending thread fed by a bounded command queue, so starting and stopping never opens devices or
+     * creates threads again. Opened devices stay cached by path and speed until sending to them fails. Device that
+     * fails while sending is waited for and reopened, and sending goes on where it stopped until stop is posted.
+     * Commands may be posted from any thread, events are reported from worker threads.
+     */
+    class sender_worker {
+    public:
+        enum class event_type {
+            started,            // message holds applied port speed
+            device_open_error,
+            send_error,
+            device_lost,        // message holds the error, started follows once device is back
+            command_error,      // command was rejected, sending goes on
+            stopped             // message holds jitter statistics in realtime mode
+        };
+        using event_handler = std::function<void(const event_type, const std::string&)>;
+
+        static constexpr size_t default_queue_capacity = 64;
+
+        explicit sender_worker(const event_handler& on_event, const size_t queue_capacity = default_queue_capacity);
+        ~sender_worker();
+        sender_worker(const sender_worker&) = delete;
+        sender_worker& operator=(const sender_worker&) = delete;
+
+        // Return false when command queue is full
+        bool start(const send_job& job);
+        bool stop();
+        bool update_text(const std::string& text);
+        bool set_period(const std::chrono::microseconds& period);
+
+        // Metrics of the device being sent to, or of the last one
+        metrics_snapshot get_metrics() const;
+        // Single reader only, see fpga_sender::poll_progress
+        bool poll_progress(ticker_progress& latest);
+
+    private:
+        enum class command_type { start, stop, update_text, set_period };
+        struct command {
+            command_type type;
+            send_job job;
+        };
+        using device_key = std::pair<std::string, uint32_t>;
+        struct cached_device {
+            std::shared_ptr<serial_device> device;
+            std::unique_ptr<fpga_sender> sender;
+        };
+
+        bool post(command next);
+        void dispatching_routine();
+        void sending_routine();
+        void stop_active(std::unique_lock<std::mutex>& lock);
+        cached_device* open_device(const send_job& job);
+        // Reports device lost and waits for it to come back, false when stopped meanwhile
+        bool wait_for_device(const send_job& job, serial_device& device, const std::string& error);
+        void close_device(const send_job& job);
+
+        const event_handler on_event;
+        const size_t queue_capacity;
+        std::atomic_bool running;
+
+        std::mutex queue_mx;
+        std::condition_variable queue_cv;
+        std::deque<command> commands;
+
+        mutable std::mutex job_mx;
+        std::condition_variable job_cv;
+        bool has_pending_job, job_running, job_cancelled, job_superseded;
+        send_job pending_job, current_job;
+        fpga_sender* active_sender;
+        fpga_sender* last_sender;
+        device_watcher* active_watcher;
+
+        // Touched by sending thread only, apart from destruction
+        std::map<device_key, cached_device> devices;
+
+        std::thread dispatching_thread, sending_thread;
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_SENDER_WORKER_H
@@ -1,16 +1,19 @@
 #include "serial_device.h"
+#include "byte_trace.h"
 #include <stdexcept>
 
 using namespace fpga_ticker_client;
 
 #ifdef __unix__
+#include <cerrno>
 #include <fcntl.h>
+#include <poll.h>
 #include <termios.h>
 #include <unistd.h>
 #include <unordered_map>
+#include "serial_termios2.h"
 
-serial_device::serial_device(const std::string &path, const uint32_t speed) : device(-1)
-{
+namespace {
     const std::unordered_map<uint32_t, speed_t> serial_speeds = {
         { 0, B0 },
         { 50, B50 },
@@ -30,44 +33,140 @@ serial_device::serial_device(const std::string &path, const uint32_t speed) : de
         { 38400, B38400 },
         { 57600, B57600 },
         { 115200, B115200 },
-        { 230400, B230400 }
+        { 230400, B230400 },
+#ifdef B460800
+        { 460800, B460800 },
+#endif
+#ifdef B500000
+        { 500000, B500000 },
+#endif
+#ifdef B576000
+        { 576000, B576000 },
+#endif
+#ifdef B921600
+        { 921600, B921600 },
+#endif
+#ifdef B1000000
+        { 1000000, B1000000 },
+#endif
+#ifdef B1152000
+        { 1152000, B1152000 },
+#endif
+#ifdef B1500000
+        { 1500000, B1500000 },
+#endif
+#ifdef B2000000
+        { 2000000, B2000000 },
+#endif
+#ifdef B2500000
+        { 2500000, B2500000 },
+#endif
+#ifdef B3000000
+        { 3000000, B3000000 },
+#endif
+#ifdef B3500000
+        { 3500000, B3500000 },
+#endif
+#ifdef B4000000
+        { 4000000, B4000000 },
+#endif
     };
 
-    try {
-        const speed_t port_speed = serial_speeds.at(speed);
-
-        device = open(path.c_str(), O_RDWR | O_NOCTTY);
-        if (device != -1) {
-            if(isatty(device)) {
-                struct termios config = {};
-
-                if (tcgetattr(device, &config) != -1) {
-                    config.c_oflag = 0;
-                    config.c_lflag &= ~(ECHO | ECHONL | ICANON | IEXTEN | ISIG);
-                    config.c_cflag &= ~(CSIZE | PARENB);
-                    config.c_cflag |= CS8;
-                    config.c_cc[VTIME] = 0;
-
-                    if ((cfsetospeed(&config, port_speed == -1))
-                        || (tcsetattr(device, TCSANOW, &config) == -1)) {
-                        close(device);
-                        device = -1;
-                    }
-                } else {
-                    close(device);
-                    device = -1;
-                }
-            } else {
-                close(device);
-                device = -1;
+    bool configure_device(const int device, const uint32_t speed, const serial_options& options,
+        uint32_t& applied_speed)
+    {
+        struct termios config = {};
+        if (!isatty(device) || (tcgetattr(device, &config) == -1)) {
+            return false;
+        }
+
+        config.c_oflag = 0;
+        config.c_lflag &= ~(ECHO | ECHONL | ICANON | IEXTEN | ISIG);
+        // Replies such as acknowledgements are binary: 0x0D must not become 0x0A, 0x11 and 0x13 are no XON/XOFF
+        config.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON);
+        config.c_cflag &= ~(CSIZE | PARENB);
+        config.c_cflag |= CS8 | CREAD | CLOCAL;
+        config.c_cc[VMIN] = options.vmin;
+        config.c_cc[VTIME] = options.vtime;
+        if (options.disable_flow_control) {
+#ifdef CRTSCTS
+            config.c_cflag &= ~CRTSCTS;
+#endif
+            config.c_iflag &= ~(IXOFF | IXANY);
+        }
+
+        const auto standard_speed = serial_speeds.find(speed);
+        if (standard_speed != serial_speeds.end()) {
+            if ((cfsetospeed(&config, standard_speed->second) == -1)
+                || (cfsetispeed(&config, standard_speed->second) == -1)) {
+                return false;
             }
         }
-    } catch (const std::out_of_range&) {
-        if (device != -1) {
-            close(device);
-            device = -1;
+#ifndef __linux__
+        else {
+            return false;
+        }
+#endif
+
+        if (tcsetattr(device, TCSANOW, &config) == -1) {
+            return false;
         }
+
+#ifdef __linux__
+        if ((standard_speed == serial_speeds.end()) && !set_termios2_speed(device, speed)) {
+            return false;
+        }
+        if (options.low_latency) {
+            set_serial_low_latency(device);
+        }
+        applied_speed = get_termios2_speed(device);
+#else
+        applied_speed = 0;
+        const speed_t configured_speed = cfgetospeed(&config);
+        for (const auto& known_speed : serial_speeds) {
+            if (known_speed.second == configured_speed) {
+                applied_speed = known_speed.first;
+            }
+        }
+#endif
+        return true;
+    }
+
+    [[noreturn]] void throw_device_error(const std::string& message, const int error)
+    {
+        const std::string what = message + ": " + std::to_string(error);
+        // Left by unplugged adapter or pseudo-terminal whose other side was closed
+        if ((error == EIO) || (error == ENXIO) || (error == ENODEV) || (error == EPIPE)) {
+            throw device_lost_error(what);
+        }
+        throw std::runtime_error(what);
+    }
+}
+
+serial_device::serial_device(const std::string &path, const uint32_t speed, const serial_options& options)
+    : device(-1), applied_speed(0), write_calls(0), path(path), requested_speed(speed), port_options(options),
+    trace_device(0)
+{
+    open_port();
+}
+
+void serial_device::open_port()
+{
+    device = open(path.c_str(), O_RDWR | O_NOCTTY);
+    if ((device != -1) && !configure_device(device, requested_speed, port_options, applied_speed)) {
+        close(device);
+        device = -1;
+    }
+}
+
+bool serial_device::reopen()
+{
+    if (device != -1) {
+        close(device);
+        device = -1;
     }
+    open_port();
+    return is_opened();
 }
 
 serial_device::~serial_device()
@@ -82,37 +181,177 @@ bool serial_device::is_opened() const
     return device != -1;
 }
 
+uint32_t serial_device::get_applied_speed() const
+{
+    return applied_speed;
+}
+
+uint64_t serial_device::get_write_calls() const
+{
+    return write_calls.load(std::memory_order_relaxed);
+}
+
 void serial_device::write_byte(const uint8_t byte) const
+{
+    write_bytes(&byte, sizeof(byte));
+}
+
+void serial_device::write_bytes(const uint8_t* bytes, const size_t count, const bool drain) const
+{
+    if (!is_opened()) {
+        throw std::logic_error("Device is not opened");
+    }
+
+    size_t written = 0;
+    while (written < count) {
+        write_calls.fetch_add(1, std::memory_order_relaxed);
+        const ssize_t write_result = write(device, bytes + written, count - written);
+        if (write_result > 0) {
+            trace_written(bytes + written, static_cast<size_t>(write_result));
+            written += static_cast<size_t>(write_result);
+        } else if ((write_result == 0) || (errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            struct pollfd device_poll = { device, POLLOUT, 0 };
+            if ((poll(&device_poll, 1, -1) == -1) && (errno != EINTR)) {
+                throw std::runtime_error("Error waiting for device: " + std::to_string(errno));
+            }
+        } else if (errno != EINTR) {
+            throw_device_error("Error writing data to device", errno);
+        }
+    }
+
+    if (drain) {
+        while (tcdrain(device) == -1) {
+            if (errno != EINTR) {
+                throw_device_error("Error draining device output", errno);
+            }
+        }
+    }
+}
+
+size_t serial_device::write_available(const uint8_t* bytes, const size_t count) const
+{
+    if (!is_opened()) {
+        throw std::logic_error("Device is not opened");
+    }
+
+    size_t written = 0;
+    while (written < count) {
+        write_calls.fetch_add(1, std::memory_order_relaxed);
+        const ssize_t write_result = write(device, bytes + written, count - written);
+        if (write_result > 0) {
+            trace_written(bytes + written, static_cast<size_t>(write_result));
+            written += static_cast<size_t>(write_result);
+        } else if ((write_result == 0) || (errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            break;
+        } else if (errno != EINTR) {
+            throw_device_error("Error writing data to device", errno);
+        }
+    }
+    return written;
+}
+
+size_t serial_device::read_bytes(uint8_t* bytes, const size_t count, const std::chrono::milliseconds& timeout) const
+{
+    if (!is_opened()) {
+        throw std::logic_error("Device is not opened");
+    }
+
+    struct pollfd device_poll = { device, POLLIN, 0 };
+    const int poll_result = poll(&device_poll, 1, static_cast<int>(timeout.count()));
+    if (poll_result == -1) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        throw std::runtime_error("Error waiting for device: " + std::to_string(errno));
+    }
+    return (poll_result == 0) ? 0 : read_available(bytes, count);
+}
+
+size_t serial_device::read_available(uint8_t* bytes, const size_t count) const
 {
     if (!is_opened()) {
         throw std::logic_error("Device is not opened");
     }
 
-    ssize_t write_result;
-    do {
-        write_result = write(device, &byte, sizeof(byte));
-    } while ((write_result != -1) && (write_result != sizeof(byte)));
+    // Poll first, so blocking descriptor is never read while empty
+    struct pollfd device_poll = { device, POLLIN, 0 };
+    if ((count == 0) || (poll(&device_poll, 1, 0) <= 0) || ((device_poll.revents & POLLIN) == 0)) {
+        return 0;
+    }
+    const ssize_t read_result = read(device, bytes, count);
+    if (read_result == -1) {
+        if ((errno == EINTR) || (errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            return 0;
+        }
+        throw_device_error("Error reading data from device", errno);
+    }
+    return static_cast<size_t>(read_result);
+}
 
-    if (write_result == sizeof(byte)) {
-        tcflush(device, TCOFLUSH);
-    } else {
-        throw std::runtime_error("Error writing data to device: " + std::to_string(errno));
+void serial_device::set_non_blocking(const bool non_blocking) const
+{
+    if (!is_opened()) {
+        throw std::logic_error("Device is not opened");
+    }
+
+    const int flags = fcntl(device, F_GETFL);
+    if ((flags == -1)
+        || (fcntl(device, F_SETFL, non_blocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK)) == -1)) {
+        throw std::runtime_error("Error changing device blocking mode: " + std::to_string(errno));
     }
 }
 
+serial_device::native_handle_type serial_device::native_handle() const
+{
+    return device;
+}
+
 #elif defined (_WIN32) || defined(_WIN64)
-serial_device::serial_device(const std::string& path, const uint32_t speed) : device(INVALID_HANDLE_VALUE)
+namespace {
+    [[noreturn]] void throw_device_error(const std::string& message, const DWORD error)
+    {
+        const std::string what = message + ": " + std::to_string(error);
+        // Reported for handle of USB adapter that was unplugged
+        if ((error == ERROR_ACCESS_DENIED) || (error == ERROR_BAD_COMMAND) || (error == ERROR_GEN_FAILURE)
+            || (error == ERROR_DEVICE_NOT_CONNECTED) || (error == ERROR_DEVICE_REMOVED)
+            || (error == ERROR_OPERATION_ABORTED)) {
+            throw device_lost_error(what);
+        }
+        throw std::runtime_error(what);
+    }
+}
+
+serial_device::serial_device(const std::string& path, const uint32_t speed, const serial_options& options)
+    : device(INVALID_HANDLE_VALUE), applied_speed(0), write_calls(0), path(path), requested_speed(speed),
+    port_options(options), trace_device(0)
 {
+    open_port();
+}
 
-    device = CreateFileA(path.c_str(), GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+void serial_device::open_port()
+{
+    device = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
     if (device != INVALID_HANDLE_VALUE) {
         DCB comm_state;
         if (GetCommState(device, &comm_state) == TRUE) {
-            comm_state.BaudRate = speed;
+            comm_state.BaudRate = requested_speed;
             comm_state.ByteSize = sizeof(uint8_t) * 8;
             comm_state.DCBlength = sizeof(comm_state);
             comm_state.fBinary = TRUE;
-            if (SetCommState(device, &comm_state) == FALSE) {
+            // Received bytes are binary replies, none of them is taken for XON/XOFF or replaced on parity error
+            comm_state.fOutX = FALSE;
+            comm_state.fParity = FALSE;
+            comm_state.fErrorChar = FALSE;
+            comm_state.fNull = FALSE;
+            if (port_options.disable_flow_control) {
+                comm_state.fOutxCtsFlow = FALSE;
+                comm_state.fOutxDsrFlow = FALSE;
+                comm_state.fRtsControl = RTS_CONTROL_ENABLE;
+                comm_state.fInX = FALSE;
+            }
+            if ((SetCommState(device, &comm_state) == TRUE) && (GetCommState(device, &comm_state) == TRUE)) {
+                applied_speed = comm_state.BaudRate;
+            } else {
                 CloseHandle(device);
                 device = INVALID_HANDLE_VALUE;
             }
@@ -123,6 +362,16 @@ serial_device::serial_device(const std::string& path, const uint32_t speed) : de
     }
 }
 
+bool serial_device::reopen()
+{
+    if (device != INVALID_HANDLE_VALUE) {
+        CloseHandle(device);
+        device = INVALID_HANDLE_VALUE;
+    }
+    open_port();
+    return is_opened();
+}
+
 serial_device::~serial_device()
 {
     if (device != INVALID_HANDLE_VALUE) {
@@ -135,23 +384,142 @@ bool serial_device::is_opened() const
     return device != INVALID_HANDLE_VALUE;
 }
 
+uint32_t serial_device::get_applied_speed() const
+{
+    return applied_speed;
+}
+
+uint64_t serial_device::get_write_calls() const
+{
+    return write_calls.load(std::memory_order_relaxed);
+}
+
 void serial_device::write_byte(const uint8_t byte) const
+{
+    write_bytes(&byte, sizeof(byte));
+}
+
+void serial_device::write_bytes(const uint8_t* bytes, const size_t count, const bool drain) const
+{
+    if (!is_opened()) {
+        throw std::logic_error("Device is not opened");
+    }
+
+    size_t written = 0;
+    while (written < count) {
+        DWORD write_count;
+        write_calls.fetch_add(1, std::memory_order_relaxed);
+        if (WriteFile(device, bytes + written, static_cast<DWORD>(count - written), &write_count, NULL) == FALSE) {
+            throw_device_error("Error writing data to device", GetLastError());
+        }
+        trace_written(bytes + written, write_count);
+        written += write_count;
+    }
+
+    if (drain && (FlushFileBuffers(device) == FALSE)) {
+        throw_device_error("Error draining device output", GetLastError());
+    }
+}
+
+size_t serial_device::write_available(const uint8_t* bytes, const size_t count) const
 {
     if (!is_opened()) {
         throw std::logic_error("Device is not opened");
     }
 
-    BOOL write_result;
     DWORD write_count;
-    do {
-        write_result = WriteFile(device, &byte, sizeof(byte), &write_count, NULL);
-    } while ((write_result == TRUE) && (write_count != sizeof(byte)));
+    write_calls.fetch_add(1, std::memory_order_relaxed);
+    if (WriteFile(device, bytes, static_cast<DWORD>(count), &write_count, NULL) == FALSE) {
+        throw_device_error("Error writing data to device", GetLastError());
+    }
+    trace_written(bytes, write_count);
+    return write_count;
+}
+
+size_t serial_device::read_bytes(uint8_t* bytes, const size_t count, const std::chrono::milliseconds& timeout) const
+{
+    if (!is_opened()) {
+        throw std::logic_error("Device is not opened");
+    }
+
+    // Return as soon as anything arrived, or after timeout; write timeouts are kept
+    COMMTIMEOUTS timeouts;
+    if (GetCommTimeouts(device, &timeouts) == FALSE) {
+        throw std::runtime_error("Error reading device timeouts: " + std::to_string(GetLastError()));
+    }
+    timeouts.ReadIntervalTimeout = MAXDWORD;
+    timeouts.ReadTotalTimeoutMultiplier = MAXDWORD;
+    timeouts.ReadTotalTimeoutConstant = (timeout.count() > 0) ? static_cast<DWORD>(timeout.count()) : 1;
+    if (SetCommTimeouts(device, &timeouts) == FALSE) {
+        throw std::runtime_error("Error changing device timeouts: " + std::to_string(GetLastError()));
+    }
 
-    if (write_result == TRUE) {
-        FlushFileBuffers(device);
-    } else {
-        throw std::runtime_error("Error writing data to device: " + std::to_string(GetLastError()));
+    DWORD read_count;
+    if (ReadFile(device, bytes, static_cast<DWORD>(count), &read_count, NULL) == FALSE) {
+        throw_device_error("Error reading data from device", GetLastError());
     }
+    return read_count;
+}
+
+size_t serial_device::read_available(uint8_t* bytes, const size_t count) const
+{
+    if (!is_opened()) {
+        throw std::logic_error("Device is not opened");
+    }
+
+    COMMTIMEOUTS timeouts;
+    if (GetCommTimeouts(device, &timeouts) == FALSE) {
+        throw std::runtime_error("Error reading device timeouts: " + std::to_string(GetLastError()));
+    }
+    // Interval timeout of MAXDWORD with zero totals returns immediately with whatever was received
+    timeouts.ReadIntervalTimeout = MAXDWORD;
+    timeouts.ReadTotalTimeoutMultiplier = 0;
+    timeouts.ReadTotalTimeoutConstant = 0;
+    if (SetCommTimeouts(device, &timeouts) == FALSE) {
+        throw std::runtime_error("Error changing device timeouts: " + std::to_string(GetLastError()));
+    }
+
+    DWORD read_count;
+    if (ReadFile(device, bytes, static_cast<DWORD>(count), &read_count, NULL) == FALSE) {
+        throw_device_error("Error reading data from device", GetLastError());
+    }
+    return read_count;
+}
+
+void serial_device::set_non_blocking(const bool non_blocking) const
+{
+    if (!is_opened()) {
+        throw std::logic_error("Device is not opened");
+    }
+
+    // Closest to non-blocking writes that comm timeouts allow: give up after a millisecond
+    COMMTIMEOUTS timeouts;
+    if (GetCommTimeouts(device, &timeouts) == FALSE) {
+        throw std::runtime_error("Error reading device timeouts: " + std::to_string(GetLastError()));
+    }
+    timeouts.WriteTotalTimeoutMultiplier = 0;
+    timeouts.WriteTotalTimeoutConstant = non_blocking ? 1 : 0;
+    if (SetCommTimeouts(device, &timeouts) == FALSE) {
+        throw std::runtime_error("Error changing device blocking mode: " + std::to_string(GetLastError()));
+    }
+}
+
+serial_device::native_handle_type serial_device::native_handle() const
+{
+    return device;
 }
 
 #endif
+
+void serial_device::attach_trace(const std::shared_ptr<byte_trace_recorder>& recorder)
+{
+    trace_device = recorder ? recorder->register_device(path) : 0;
+    trace = recorder;
+}
+
+void serial_device::trace_written(const uint8_t* bytes, const size_t count) const
+{
+    if (trace) {
+        trace->record(trace_device, bytes, count);
+    }
+}
@@ -3,27 +3,82 @@
 
 
 #include <string>
+#include <atomic>
+#include <memory>
+#include <chrono>
 #include <cstdint>
+#include <cstddef>
+#include <stdexcept>
 
 #if defined (_WIN32) || defined(_WIN64)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
 #include <Windows.h>
 #endif
 
 namespace fpga_ticker_client {
+    struct serial_options {
+        bool low_latency = false;           // ASYNC_LOW_LATENCY on Linux drivers that support it, best effort
+        bool disable_flow_control = false;  // clear RTS/CTS and input XON/XOFF, output one is always off
+        uint8_t vmin = 1;
+        uint8_t vtime = 0;
+    };
+
+    // I/O error of device that went away, such as unplugged USB adapter; reopening it may bring it back
+    class device_lost_error : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    class byte_trace_recorder;
+
     class serial_device {
     public:
-        serial_device(const std::string& path, const uint32_t speed);
+#ifdef __unix__
+        using native_handle_type = int;
+#elif defined (_WIN32) || defined(_WIN64)
+        using native_handle_type = HANDLE;
+#endif
+
+        serial_device(const std::string& path, const uint32_t speed, const serial_options& options = serial_options());
         ~serial_device();
 
         bool is_opened() const;
+        // Closes port and opens its path again with the same settings, for adapter that was unplugged and came back.
+        // Nothing may write to the device meanwhile
+        bool reopen();
+        // Port speed driver reports after configuration, may differ from requested one
+        uint32_t get_applied_speed() const;
+        // Number of write system calls issued so far
+        uint64_t get_write_calls() const;
         void write_byte(const uint8_t byte) const;
+        void write_bytes(const uint8_t* bytes, const size_t count, const bool drain = false) const;
+        // Writes as many bytes as device accepts right now, returns number of bytes written
+        size_t write_available(const uint8_t* bytes, const size_t count) const;
+        // Waits up to timeout for incoming data, returns number of bytes read, zero on timeout
+        size_t read_bytes(uint8_t* bytes, const size_t count, const std::chrono::milliseconds& timeout) const;
+        // Reads bytes already received without waiting
+        size_t read_available(uint8_t* bytes, const size_t count) const;
+
+        // Records every byte written afterwards under device path, attach before writing starts
+        void attach_trace(const std::shared_ptr<byte_trace_recorder>& recorder);
+
+        void set_non_blocking(const bool non_blocking) const;
+        native_handle_type native_handle() const;
 
     private:
-#ifdef __unix__
-        int device;
-#elif defined (_WIN32) || defined(_WIN64)
-        HANDLE device;
-#endif
+        void open_port();
+        void trace_written(const uint8_t* bytes, const size_t count) const;
+
+        native_handle_type device;
+        uint32_t applied_speed;
+        mutable std::atomic<uint64_t> write_calls;
+        std::string path;
+        uint32_t requested_speed;
+        serial_options port_options;
+        std::shared_ptr<byte_trace_recorder> trace;
+        uint16_t trace_device;
     };
 }
 
@@ -0,0 +1,41 @@
+#include "serial_termios2.h"
+
+#ifdef __linux__
+#include <asm/termbits.h>
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+
+bool fpga_ticker_client::set_termios2_speed(const int device, const uint32_t speed)
+{
+    struct termios2 config = {};
+    if (ioctl(device, TCGETS2, &config) == -1) {
+        return false;
+    }
+
+    config.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+    config.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+    config.c_ospeed = speed;
+    config.c_ispeed = speed;
+    return ioctl(device, TCSETS2, &config) != -1;
+}
+
+uint32_t fpga_ticker_client::get_termios2_speed(const int device)
+{
+    struct termios2 config = {};
+    if (ioctl(device, TCGETS2, &config) == -1) {
+        return 0;
+    }
+    return config.c_ospeed;
+}
+
+bool fpga_ticker_client::set_serial_low_latency(const int device)
+{
+    struct serial_struct serial_settings = {};
+    if (ioctl(device, TIOCGSERIAL, &serial_settings) == -1) {
+        return false;
+    }
+    serial_settings.flags |= ASYNC_LOW_LATENCY;
+    return ioctl(device, TIOCSSERIAL, &serial_settings) != -1;
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_SERIAL_TERMIOS2_H
+#define DDS_FPGA_TICKER_CLIENT_SERIAL_TERMIOS2_H
+
+
+#include <cstdint>
+
+/*
+ * Linux-only helpers kept in a separate translation unit: <asm/termbits.h> needed for termios2 clashes with
+ * <termios.h> used by serial_device.
+ */
+namespace fpga_ticker_client {
+    // Sets arbitrary input and output speed using BOTHER
+    bool set_termios2_speed(const int device, const uint32_t speed);
+    // Returns output speed driver actually applied, 0 on error
+    uint32_t get_termios2_speed(const int device);
+    bool set_serial_low_latency(const int device);
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_SERIAL_TERMIOS2_H
@@ -0,0 +1,305 @@
+#include "session_pool.h"
+#include "fpga_sender.h"
+#include "frame_exchange.h"
+#include "ticker_cycle.h"
+#include "ticker_scheduler.h"
+#include <stdexcept>
+#include <algorithm>
+#include <atomic>
+
+using namespace fpga_ticker_client;
+
+namespace {
+    // Same as device_watcher retries at, without the inotify wait that would hold a worker
+    const std::chrono::milliseconds reconnect_interval(500);
+}
+
+struct session_pool::session {
+    session(std::unique_ptr<frame_exchange::frame> characters, const session_settings& settings)
+        : settings(settings), ticking(false), removed(false), reconnecting(false), cycle(std::move(characters)),
+        schedule(settings.period), bytes_sent(0), dropped_characters(0), missed_ticks(0), max_lateness(0),
+        symbol(0xFF), character(0), frame_size(cycle.size()), failed(false)
+    { }
+
+    size_t id = 0;
+    std::shared_ptr<serial_device> device;
+    // Guarded by pool_mx; period is handed to schedule at the next tick
+    session_settings settings;
+    bool ticking, removed, reconnecting;
+    std::string error;
+    // Used by the worker holding the session only, apart from text published to cycle
+    ticker_cycle cycle;
+    ticker_scheduler schedule;
+    // Progress and counters, read by status without locking
+    std::atomic<uint64_t> bytes_sent, dropped_characters, missed_ticks;
+    std::atomic<int64_t> max_lateness;
+    std::atomic<uint8_t> symbol;
+    std::atomic<size_t> character, frame_size;
+    std::atomic_bool failed;
+};
+
+size_t session_pool::default_workers()
+{
+    return std::max(1u, std::min(std::thread::hardware_concurrency(), 4u));
+}
+
+session_pool::session_pool(const size_t workers) : next_session_id(0), running(true), timed_waiter(false)
+{
+    if (workers == 0) {
+        throw std::invalid_argument("Session pool needs at least one worker");
+    }
+    for (size_t worker_no = 0; worker_no < workers; ++worker_no) {
+        this->workers.emplace_back(&session_pool::working_routine, this);
+    }
+}
+
+session_pool::~session_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(pool_mx);
+        running = false;
+    }
+    pool_cv.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+size_t session_pool::add_session(const session_settings& settings)
+{
+    if (settings.period <= clock::duration::zero()) {
+        throw std::invalid_argument("Session period must be positive");
+    }
+
+    auto characters = std::make_unique<frame_exchange::frame>(fpga_sender::transform_text(settings.text,
+        *settings.font));
+    if (characters->empty()) {
+        throw std::runtime_error("Text to send is empty");
+    }
+    auto added = std::make_shared<session>(std::move(characters), settings);
+    added->device = std::make_shared<serial_device>(settings.device_path, settings.speed, settings.port_settings);
+    if (!added->device->is_opened()) {
+        throw std::runtime_error("Error opening device " + settings.device_path);
+    }
+    added->device->set_non_blocking(true);
+
+    const clock::time_point now = clock::now();
+    added->schedule.restart(now);
+    std::lock_guard<std::mutex> lock(pool_mx);
+    added->id = next_session_id++;
+    sessions.emplace(added->id, added);
+    schedule(*added, now, false);
+    return added->id;
+}
+
+void session_pool::remove_session(const size_t session_id)
+{
+    std::shared_ptr<session> removed;
+    {
+        std::unique_lock<std::mutex> lock(pool_mx);
+        const auto found = sessions.find(session_id);
+        if (found == sessions.end()) {
+            throw std::out_of_range("No session " + std::to_string(session_id));
+        }
+        removed = found->second;
+        removed->removed = true;
+        sessions.erase(found);
+        idle_cv.wait(lock, [&removed] { return !removed->ticking; });
+    }
+    // Last reference closes the device outside of the lock
+}
+
+void session_pool::update_text(const size_t session_id, const std::string& text)
+{
+    const std::shared_ptr<session> updated = find_session(session_id);
+    auto characters = std::make_unique<frame_exchange::frame>(fpga_sender::transform_text(text,
+        *updated->settings.font));
+    if (characters->empty()) {
+        throw std::runtime_error("Text to send is empty");
+    }
+
+    std::lock_guard<std::mutex> lock(pool_mx);
+    updated->settings.text = text;
+    updated->cycle.publish(std::move(characters));
+}
+
+void session_pool::set_period(const size_t session_id, const std::chrono::steady_clock::duration& period)
+{
+    if (period <= clock::duration::zero()) {
+        throw std::invalid_argument("Session period must be positive");
+    }
+
+    const std::shared_ptr<session> updated = find_session(session_id);
+    std::lock_guard<std::mutex> lock(pool_mx);
+    updated->settings.period = period;
+}
+
+std::vector<session_status> session_pool::get_status() const
+{
+    std::lock_guard<std::mutex> lock(pool_mx);
+    std::vector<session_status> statuses;
+    statuses.reserve(sessions.size());
+    for (const auto& entry : sessions) {
+        const session& listed = *entry.second;
+        session_status status;
+        status.id = listed.id;
+        status.device_path = listed.settings.device_path;
+        // Device may be reopened by a worker meanwhile
+        status.speed = listed.reconnecting ? listed.settings.speed : listed.device->get_applied_speed();
+        status.text = listed.settings.text;
+        status.period = listed.settings.period;
+        status.bytes_sent = listed.bytes_sent;
+        status.dropped_characters = listed.dropped_characters;
+        status.missed_ticks = listed.missed_ticks;
+        status.max_lateness = std::chrono::nanoseconds(listed.max_lateness.load());
+        status.symbol = listed.symbol;
+        status.character = listed.character;
+        status.frame_size = listed.frame_size;
+        status.reconnecting = listed.reconnecting;
+        status.failed = listed.failed;
+        status.error = listed.error;
+        statuses.push_back(status);
+    }
+    return statuses;
+}
+
+size_t session_pool::get_workers() const
+{
+    return workers.size();
+}
+
+void session_pool::working_routine()
+{
+    std::unique_lock<std::mutex> lock(pool_mx);
+    while (running) {
+        // One worker sleeps until the earliest deadline, the rest wait to be handed the next one
+        if (deadlines.empty() || timed_waiter) {
+            pool_cv.wait(lock);
+            continue;
+        }
+        const deadline next = deadlines.top();
+        if (clock::now() < next.first) {
+            timed_waiter = true;
+            pool_cv.wait_until(lock, next.first);
+            timed_waiter = false;
+            continue;
+        }
+
+        deadlines.pop();
+        if (!deadlines.empty()) {
+            pool_cv.notify_one();
+        }
+        const auto found = sessions.find(next.second);
+        if (found == sessions.end()) {
+            continue;
+        }
+        const std::shared_ptr<session> ticked = found->second;
+        const clock::duration period = ticked->settings.period;
+        const bool reconnecting = ticked->reconnecting;
+        ticked->ticking = true;
+        lock.unlock();
+
+        clock::time_point next_deadline = clock::now() + reconnect_interval;
+        bool reopened = false, lost = false;
+        std::string error;
+        try {
+            if (reconnecting) {
+                reopened = reopen(*ticked);
+                if (reopened) {
+                    next_deadline = ticked->schedule.next_deadline();
+                }
+            } else {
+                next_deadline = tick(*ticked, period);
+            }
+        } catch (const device_lost_error& e) {
+            error = e.what();
+            lost = true;
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+
+        lock.lock();
+        ticked->ticking = false;
+        if (lost) {
+            ticked->error = error;
+            ticked->reconnecting = true;
+            next_deadline = clock::now() + reconnect_interval;
+        } else if (!error.empty()) {
+            // Only device that went away is waited for, other failures would just repeat
+            ticked->error = error;
+            ticked->reconnecting = false;
+            ticked->failed = true;
+        } else if (reopened) {
+            ticked->error.clear();
+            ticked->reconnecting = false;
+        }
+        if (!ticked->removed && !ticked->failed) {
+            schedule(*ticked, next_deadline, true);
+        }
+        idle_cv.notify_all();
+    }
+}
+
+session_pool::clock::time_point session_pool::tick(session& ticked, const clock::duration& period) const
+{
+    const clock::time_point now = clock::now();
+    const size_t elapsed_ticks = ticked.schedule.advance(now);
+    if (period != ticked.schedule.get_period()) {
+        ticked.schedule.set_period(period, now);
+    }
+    const int64_t lateness = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        ticked.schedule.get_last_lateness()).count();
+    if (lateness > ticked.max_lateness) {
+        ticked.max_lateness = lateness;
+    }
+    ticked.missed_ticks += elapsed_ticks - 1;
+
+    // Device is non-blocking: a character it cannot take now is dropped rather than delaying other sessions
+    const uint8_t symbol = ticked.cycle.advance(elapsed_ticks);
+    try {
+        if (ticked.device->write_available(&symbol, 1) == 1) {
+            ++ticked.bytes_sent;
+        } else {
+            ++ticked.dropped_characters;
+        }
+    } catch (...) {
+        // Session resumed after reconnecting sends it again
+        ticked.cycle.rewind();
+        throw;
+    }
+    ticked.symbol = symbol;
+    ticked.character = ticked.cycle.position();
+    ticked.frame_size = ticked.cycle.size();
+
+    return ticked.schedule.next_deadline();
+}
+
+bool session_pool::reopen(session& lost) const
+{
+    if (!lost.device->reopen()) {
+        return false;
+    }
+    lost.device->set_non_blocking(true);
+    lost.schedule.restart(clock::now());
+    return true;
+}
+
+void session_pool::schedule(session& scheduled, const clock::time_point& session_deadline, const bool from_worker)
+{
+    const bool earliest = deadlines.empty() || (session_deadline < deadlines.top().first);
+    deadlines.emplace(session_deadline, scheduled.id);
+    // Worker rescheduling its session checks the heap again itself, others must be told
+    if (timed_waiter ? earliest : !from_worker) {
+        pool_cv.notify_all();
+    }
+}
+
+std::shared_ptr<session_pool::session> session_pool::find_session(const size_t session_id) const
+{
+    std::lock_guard<std::mutex> lock(pool_mx);
+    const auto found = sessions.find(session_id);
+    if (found == sessions.end()) {
+        throw std::out_of_range("No session " + std::to_string(session_id));
+    }
+    return found->second;
+}
@@ -0,0 +1,104 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_SESSION_POOL_H
+#define DDS_FPGA_TICKER_CLIENT_SESSION_POOL_H
+
+
+#include <map>
+#include <queue>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <utility>
+#include <functional>
+#include <condition_variable>
+#include <cstdint>
+#include "serial_device.h"
+#include "glyph_font.h"
+
+namespace fpga_ticker_client {
+    struct session_settings {
+        std::string device_path;
+        uint32_t speed = 0;
+        std::string text;
+        std::chrono::steady_clock::duration period = std::chrono::steady_clock::duration::zero();
+        serial_options port_settings;
+        std::shared_ptr<const glyph_font> font = glyph_font::builtin();
+    };
+
+    struct session_status {
+        size_t id;
+        std::string device_path;
+        uint32_t speed;
+        std::string text;
+        std::chrono::steady_clock::duration period;
+        uint64_t bytes_sent;
+        uint64_t dropped_characters;    // device was not writable when character was due
+        uint64_t missed_ticks;          // worker came too late to send character at all
+        std::chrono::nanoseconds max_lateness;
+        uint8_t symbol;
+        size_t character;
+        size_t frame_size;
+        bool reconnecting;              // device went away, session goes on from the same place once it is back
+        bool failed;
+        std::string error;
+    };
+
+    /*
+     * Runs any number of ticker sessions on a fixed set of worker threads. Every session has one entry in a shared
+     * deadline heap; the worker that pops it writes the due character without blocking and puts the session back
+     * with its next deadline, so a session is never ticked by two workers at once and idle sessions cost nothing.
+     * Sessions keep position and time with ticker_cycle and ticker_scheduler like ticker_fanout tickers do, the pool
+     * only adds the workers front-ends need on every platform; all methods may be called from any thread.
+     * Session whose device went away keeps its heap entry, and whichever worker pops it tries to reopen the device
+     * twice a second, so an unplugged adapter holds up neither workers nor other sessions and costs no thread.
+     */
+    class session_pool {
+    public:
+        static size_t default_workers();
+
+        explicit session_pool(const size_t workers = default_workers());
+        ~session_pool();
+        session_pool(const session_pool&) = delete;
+        session_pool& operator=(const session_pool&) = delete;
+
+        // Opens device and schedules session right away, returns its id
+        size_t add_session(const session_settings& settings);
+        // Waits for a tick in progress, so device is closed and free when it returns
+        void remove_session(const size_t session_id);
+        // Taken at the next tick of the session, text starts over from its first character
+        void update_text(const size_t session_id, const std::string& text);
+        // Next tick is still due at the old period, the following ones at the new one
+        void set_period(const size_t session_id, const std::chrono::steady_clock::duration& period);
+
+        // Snapshot of all sessions ordered by id, cheap enough to poll from UI timer
+        std::vector<session_status> get_status() const;
+        size_t get_workers() const;
+
+    private:
+        using clock = std::chrono::steady_clock;
+        struct session;
+        // Entries of removed sessions are skipped
+        using deadline = std::pair<clock::time_point, size_t>;
+        using deadline_queue = std::priority_queue<deadline, std::vector<deadline>, std::greater<deadline>>;
+
+        void working_routine();
+        clock::time_point tick(session& ticked, const clock::duration& period) const;
+        // True once device is back, session then goes on right away from the character it failed on
+        bool reopen(session& lost) const;
+        void schedule(session& scheduled, const clock::time_point& session_deadline, const bool from_worker);
+        std::shared_ptr<session> find_session(const size_t session_id) const;
+
+        mutable std::mutex pool_mx;
+        std::condition_variable pool_cv, idle_cv;
+        std::map<size_t, std::shared_ptr<session>> sessions;
+        deadline_queue deadlines;
+        size_t next_session_id;
+        bool running, timed_waiter;
+        std::vector<std::thread> workers;
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_SESSION_POOL_H
@@ -0,0 +1,141 @@
+#include "seven_segment_encoder.h"
+#include <algorithm>
+#include <initializer_list>
+
+using namespace fpga_ticker_client;
+
+namespace {
+    /*
+     * Segment encoding
+     *      0
+     *     ---
+     *  5 |   | 1
+     *     ---   <- 6
+     *  4 |   | 2
+     *     ---
+     *      3
+     */
+
+    using glyph_table = std::array<seven_segment_glyph, 256>;
+
+    constexpr std::uint8_t generate_seven_segment_symbol(const std::initializer_list<std::uint8_t> segments)
+    {
+        std::uint8_t symbol = 0xFF;
+        for (const std::uint8_t segment : segments) {
+            symbol &= ~(std::uint8_t)(1u << segment);
+        }
+        return symbol;
+    }
+
+    constexpr void set_glyph(glyph_table& table, const char character,
+        const std::initializer_list<std::uint8_t> symbols)
+    {
+        seven_segment_glyph glyph = { { }, 0 };
+        for (const std::uint8_t symbol : symbols) {
+            glyph.symbols[glyph.length++] = symbol;
+        }
+
+        table[static_cast<unsigned char>(character)] = glyph;
+        if ((character >= 'a') && (character <= 'z')) {
+            table[static_cast<unsigned char>(character - 'a' + 'A')] = glyph;
+        }
+    }
+
+    constexpr glyph_table generate_glyph_table()
+    {
+        glyph_table table = { };
+
+        set_glyph(table, 'a', { generate_seven_segment_symbol({ 0, 1, 2, 4, 5, 6 }) });
+        set_glyph(table, 'b', { generate_seven_segment_symbol({ 2, 3, 4, 5, 6 }) });
+        set_glyph(table, 'c', { generate_seven_segment_symbol({ 0, 3, 4, 5 }) });
+        set_glyph(table, 'd', { generate_seven_segment_symbol({ 1, 2, 3, 4, 6 }) });
+        set_glyph(table, 'e', { generate_seven_segment_symbol({ 0, 3, 4, 5, 6 }) });
+        set_glyph(table, 'f', { generate_seven_segment_symbol({ 0, 4, 5, 6 }) });
+        set_glyph(table, 'g', { generate_seven_segment_symbol({ 0, 2, 3, 4, 5 }) });
+        set_glyph(table, 'h', { generate_seven_segment_symbol({ 1, 2, 4, 5, 6 }) });
+        set_glyph(table, 'i', { generate_seven_segment_symbol({ 1, 2 }) });
+        set_glyph(table, 'j', { generate_seven_segment_symbol({ 1, 2, 3 }) });
+        set_glyph(table, 'k', { generate_seven_segment_symbol({ 1, 2, 4, 5, 6 }), generate_seven_segment_symbol({ 0, 3, 4, 5 }) });
+        set_glyph(table, 'l', { generate_seven_segment_symbol({ 3, 4, 5 }) });
+        set_glyph(table, 'm', { generate_seven_segment_symbol({ 0, 1, 2, 4, 5 }), generate_seven_segment_symbol({ 0, 1, 2, 4, 5 }) });
+        set_glyph(table, 'n', { generate_seven_segment_symbol({ 2, 4, 6 }) });
+        set_glyph(table, 'o', { generate_seven_segment_symbol({ 0, 1, 2, 3, 4, 5 }) });
+        set_glyph(table, 'p', { generate_seven_segment_symbol({ 0, 1, 4, 5, 6 }) });
+        set_glyph(table, 'q', { generate_seven_segment_symbol({ 0, 1, 2, 5, 6 }) });
+        set_glyph(table, 'r', { generate_seven_segment_symbol({ 4, 6 }) });
+        set_glyph(table, 's', { generate_seven_segment_symbol({ 0, 2, 3, 5, 6 }) });
+        set_glyph(table, 't', { generate_seven_segment_symbol({ 0, 1, 2 }), generate_seven_segment_symbol({ 0, 4, 5 }) });
+        set_glyph(table, 'u', { generate_seven_segment_symbol({ 1, 2, 3, 4, 5 }) });
+        set_glyph(table, 'v', { generate_seven_segment_symbol({ 1, 2, 3, 4, 5 }) });
+        set_glyph(table, 'w', { generate_seven_segment_symbol({ 1, 2, 3, 4, 5 }), generate_seven_segment_symbol({ 1, 2, 3, 4, 5 }) });
+        set_glyph(table, 'x', { generate_seven_segment_symbol({ 0, 1, 2, 3 }), generate_seven_segment_symbol({ 0, 3, 4, 5 }) });
+        set_glyph(table, 'y', { generate_seven_segment_symbol({ 1, 2, 3, 5, 6 }) });
+        set_glyph(table, 'z', { generate_seven_segment_symbol({ 0, 1, 3, 4, 6 }) });
+        set_glyph(table, '0', { generate_seven_segment_symbol({ 0, 1, 2, 3, 4, 5 }) });
+        set_glyph(table, '1', { generate_seven_segment_symbol({ 1, 2 }) });
+        set_glyph(table, '2', { generate_seven_segment_symbol({ 0, 1, 3, 4, 6 }) });
+        set_glyph(table, '3', { generate_seven_segment_symbol({ 0, 1, 2, 3, 6 }) });
+        set_glyph(table, '4', { generate_seven_segment_symbol({ 1, 2, 5, 6 }) });
+        set_glyph(table, '5', { generate_seven_segment_symbol({ 0, 2, 3, 5, 6 }) });
+        set_glyph(table, '6', { generate_seven_segment_symbol({ 0, 2, 3, 4, 5, 6 }) });
+        set_glyph(table, '7', { generate_seven_segment_symbol({ 0, 1, 2 }) });
+        set_glyph(table, '8', { generate_seven_segment_symbol({ 0, 1, 2, 3, 4, 5, 6 }) });
+        set_glyph(table, '9', { generate_seven_segment_symbol({ 0, 1, 2, 3, 5, 6 }) });
+        set_glyph(table, ' ', { generate_seven_segment_symbol({ }) });
+
+        return table;
+    }
+
+    constexpr glyph_table seven_segment_characters = generate_glyph_table();
+
+    static_assert(seven_segment_characters['a'].length == 1, "Glyph table was not generated");
+    static_assert(seven_segment_characters['K'].length == 2, "Upper case glyphs were not generated");
+    static_assert(seven_segment_characters[' '].symbols[0] == 0xFF, "Space must light no segments");
+    static_assert(seven_segment_characters['!'].length == 0, "Unsupported characters must have no symbols");
+}
+
+bool encode_status::ok() const
+{
+    return unsupported_position == npos;
+}
+
+const seven_segment_glyph& seven_segment_encoder::glyph(const char character)
+{
+    return seven_segment_characters[static_cast<unsigned char>(character)];
+}
+
+bool seven_segment_encoder::is_supported(const char character)
+{
+    return glyph(character).length != 0;
+}
+
+encode_status seven_segment_encoder::measure(const std::string_view& text)
+{
+    std::size_t size = 0;
+    for (std::size_t position = 0; position < text.size(); ++position) {
+        const std::uint8_t length = glyph(text[position]).length;
+        if (length == 0) {
+            return { size, position };
+        }
+        size += length;
+    }
+    return { size, encode_status::npos };
+}
+
+encode_status seven_segment_encoder::encode(const std::string_view& text, std::uint8_t* buffer,
+    const std::size_t capacity)
+{
+    std::size_t size = 0;
+    for (std::size_t position = 0; position < text.size(); ++position) {
+        const seven_segment_glyph& character_glyph = glyph(text[position]);
+        if (character_glyph.length == 0) {
+            return { size, position };
+        }
+        // Past the first glyph that does not fit only its size is counted, so that truncation shows
+        if (size + character_glyph.length <= capacity) {
+            std::copy_n(character_glyph.symbols.begin(), character_glyph.length, buffer + size);
+        }
+        size += character_glyph.length;
+    }
+    return { size, encode_status::npos };
+}
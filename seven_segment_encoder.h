@@ -0,0 +1,43 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_SEVEN_SEGMENT_ENCODER_H
+#define DDS_FPGA_TICKER_CLIENT_SEVEN_SEGMENT_ENCODER_H
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace fpga_ticker_client {
+    struct seven_segment_glyph {
+        static constexpr std::size_t max_symbols = 4;
+
+        std::array<std::uint8_t, max_symbols> symbols;
+        std::uint8_t length;
+    };
+
+    struct encode_status {
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        std::size_t size;
+        std::size_t unsupported_position;
+
+        bool ok() const;
+    };
+
+    class seven_segment_encoder {
+    public:
+        static const seven_segment_glyph& glyph(const char character);
+        static bool is_supported(const char character);
+
+        /*
+         * Sizing pass: returns number of symbols text encodes to, or position of first unsupported character.
+         * Fill pass: writes whole glyphs to buffer while they fit in capacity, stopping at first unsupported
+         * character. Size is that of the whole text as in sizing pass, above capacity when output was truncated.
+         */
+        static encode_status measure(const std::string_view& text);
+        static encode_status encode(const std::string_view& text, std::uint8_t* buffer, const std::size_t capacity);
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_SEVEN_SEGMENT_ENCODER_H
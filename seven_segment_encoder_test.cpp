@@ -0,0 +1,85 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include "seven_segment_encoder.h"
+
+using namespace fpga_ticker_client;
+
+namespace {
+    // Segments are active low: bit n cleared lights segment n
+    int check_table()
+    {
+        const std::vector<std::pair<char, uint8_t>> expected = {
+            { '8', 0x80 }, { '1', 0xF9 }, { '0', 0xC0 }, { 'a', 0x88 }, { 'A', 0x88 }, { ' ', 0xFF }
+        };
+        for (const auto& character : expected) {
+            const seven_segment_glyph& glyph = seven_segment_encoder::glyph(character.first);
+            if ((glyph.length != 1) || (glyph.symbols[0] != character.second)) {
+                std::cerr << "Wrong glyph of '" << character.first << "'" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        if (seven_segment_encoder::glyph('m').length != 2) {
+            std::cerr << "Wide letter does not take two symbols" << std::endl;
+            return EXIT_FAILURE;
+        }
+        for (const char character : std::string("!.,:\n\xD0")) {
+            if (seven_segment_encoder::is_supported(character)) {
+                std::cerr << "Character " << static_cast<int>(character) << " has a glyph" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        return EXIT_SUCCESS;
+    }
+
+    int check_measure()
+    {
+        const encode_status supported = seven_segment_encoder::measure("mk 1");
+        if (!supported.ok() || (supported.size != 6)) {
+            std::cerr << "Wrong size of supported text: " << supported.size << std::endl;
+            return EXIT_FAILURE;
+        }
+        const encode_status unsupported = seven_segment_encoder::measure("ab!c");
+        if (unsupported.ok() || (unsupported.unsupported_position != 2) || (unsupported.size != 2)) {
+            std::cerr << "Unsupported character was not reported at its position" << std::endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    int check_encode()
+    {
+        std::vector<uint8_t> buffer(8, 0);
+        const encode_status complete = seven_segment_encoder::encode("81", buffer.data(), buffer.size());
+        if (!complete.ok() || (complete.size != 2) || (buffer[0] != 0x80) || (buffer[1] != 0xF9)) {
+            std::cerr << "Text was not encoded" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        // Glyph that does not fit whole is not written, size still tells how much room text needs
+        buffer.assign(buffer.size(), 0);
+        const encode_status truncated = seven_segment_encoder::encode("1mm", buffer.data(), 4);
+        if (!truncated.ok() || (truncated.size != 5) || (buffer[2] == 0x00) || (buffer[3] != 0x00)) {
+            std::cerr << "Truncated output was reported as " << truncated.size << " symbols" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        const encode_status unsupported = seven_segment_encoder::encode("1:2", buffer.data(), buffer.size());
+        if (unsupported.ok() || (unsupported.unsupported_position != 1) || (unsupported.size != 1)) {
+            std::cerr << "Encoding went on past unsupported character" << std::endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+}
+
+int main()
+{
+    for (const auto check : { check_table, check_measure, check_encode }) {
+        if (check() != EXIT_SUCCESS) {
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,73 @@
+#include "seven_segment_preview.h"
+#include <algorithm>
+#include <wx/dcbuffer.h>
+
+using namespace fpga_ticker_client;
+
+namespace {
+    const wxColour background_colour(24, 24, 24), lit_colour(255, 48, 32), unlit_colour(56, 40, 40);
+    const int preview_width = 60, preview_height = 100;
+
+    bool is_lit(const uint8_t symbol, const uint8_t segment)
+    {
+        return (symbol & (1u << segment)) == 0;
+    }
+
+    // Segment rectangles in 60x100 units, numbered as in seven_segment_encoder
+    const wxRect segment_rects[] = {
+        wxRect(14, 6, 32, 8),       // 0, top
+        wxRect(46, 14, 8, 34),      // 1, top right
+        wxRect(46, 52, 8, 34),      // 2, bottom right
+        wxRect(14, 86, 32, 8),      // 3, bottom
+        wxRect(6, 52, 8, 34),       // 4, bottom left
+        wxRect(6, 14, 8, 34),       // 5, top left
+        wxRect(14, 46, 32, 8)       // 6, middle
+    };
+}
+
+seven_segment_preview::seven_segment_preview(wxWindow* parent, wxWindowID id)
+    : wxWindow(parent, id, wxDefaultPosition, wxDefaultSize, wxFULL_REPAINT_ON_RESIZE), symbol(0xFF)
+{
+    SetBackgroundStyle(wxBG_STYLE_PAINT);
+    Bind(wxEVT_PAINT, &seven_segment_preview::on_paint, this);
+}
+
+void seven_segment_preview::set_symbol(const uint8_t symbol)
+{
+    if (this->symbol != symbol) {
+        this->symbol = symbol;
+        Refresh(false);
+    }
+}
+
+uint8_t seven_segment_preview::get_symbol() const
+{
+    return symbol;
+}
+
+wxSize seven_segment_preview::DoGetBestClientSize() const
+{
+    return wxSize(preview_width, preview_height);
+}
+
+void seven_segment_preview::on_paint(wxPaintEvent&)
+{
+    wxAutoBufferedPaintDC dc(this);
+    dc.SetBackground(wxBrush(background_colour));
+    dc.Clear();
+
+    const wxSize size = GetClientSize();
+    const double scale = std::min(static_cast<double>(size.GetWidth()) / preview_width,
+        static_cast<double>(size.GetHeight()) / preview_height);
+    const int offset_x = static_cast<int>((size.GetWidth() - preview_width * scale) / 2);
+    const int offset_y = static_cast<int>((size.GetHeight() - preview_height * scale) / 2);
+
+    dc.SetPen(*wxTRANSPARENT_PEN);
+    for (uint8_t segment = 0; segment < sizeof(segment_rects) / sizeof(segment_rects[0]); ++segment) {
+        const wxRect& rect = segment_rects[segment];
+        dc.SetBrush(wxBrush(is_lit(symbol, segment) ? lit_colour : unlit_colour));
+        dc.DrawRoundedRectangle(offset_x + static_cast<int>(rect.x * scale),
+            offset_y + static_cast<int>(rect.y * scale),
+            static_cast<int>(rect.width * scale), static_cast<int>(rect.height * scale), 2 * scale);
+    }
+}
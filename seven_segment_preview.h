@@ -0,0 +1,35 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_SEVEN_SEGMENT_PREVIEW_H
+#define DDS_FPGA_TICKER_CLIENT_SEVEN_SEGMENT_PREVIEW_H
+
+
+#include <wx/wxprec.h>
+#ifndef WX_PRECOMP
+#include <wx/wx.h>
+#endif
+
+#include <cstdint>
+
+namespace fpga_ticker_client {
+    /*
+     * Draws one symbol the way board shows it: segment is lit when its bit is cleared.
+     */
+    class seven_segment_preview : public wxWindow {
+    public:
+        seven_segment_preview(wxWindow* parent, wxWindowID id = wxID_ANY);
+
+        // Repaints only when symbol actually changes
+        void set_symbol(const uint8_t symbol);
+        uint8_t get_symbol() const;
+
+    protected:
+        wxSize DoGetBestClientSize() const override;
+
+    private:
+        void on_paint(wxPaintEvent& event);
+
+        uint8_t symbol;
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_SEVEN_SEGMENT_PREVIEW_H
@@ -0,0 +1,466 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include "display_effects.h"
+#include "fpga_emulator.h"
+#include "fpga_sender.h"
+#include "glyph_font.h"
+#include "serial_device.h"
+#include "seven_segment_encoder.h"
+
+using namespace fpga_ticker_client;
+
+namespace {
+    using clock = std::chrono::steady_clock;
+
+    struct bench_options {
+        std::string output_path;
+        std::string filter;
+        std::chrono::milliseconds duration = std::chrono::milliseconds(1000);
+    };
+
+    /*
+     * Minimal writer for flat JSON objects grouped into one array per benchmark family.
+     */
+    class json_writer {
+    public:
+        json_writer()
+        {
+            stream.precision(12);
+        }
+
+        void begin_object()
+        {
+            separate();
+            stream << '{';
+            first = true;
+        }
+
+        void end_object()
+        {
+            stream << '}';
+            first = false;
+        }
+
+        void begin_array(const std::string& key)
+        {
+            write_key(key);
+            stream << '[';
+            first = true;
+        }
+
+        void end_array()
+        {
+            stream << ']';
+            first = false;
+        }
+
+        void value(const std::string& key, const std::string& text)
+        {
+            write_key(key);
+            stream << '"';
+            for (const char character : text) {
+                if ((character == '"') || (character == '\\')) {
+                    stream << '\\';
+                }
+                stream << character;
+            }
+            stream << '"';
+        }
+
+        void value(const std::string& key, const double number)
+        {
+            write_key(key);
+            stream << number;
+        }
+
+        std::string str() const
+        {
+            return stream.str();
+        }
+
+    private:
+        void separate()
+        {
+            if (!first) {
+                stream << ',';
+            }
+            first = false;
+        }
+
+        void write_key(const std::string& key)
+        {
+            separate();
+            stream << '"' << key << "\":";
+        }
+
+        std::ostringstream stream;
+        bool first = true;
+    };
+
+    double seconds_since(const clock::time_point& start)
+    {
+        return std::chrono::duration<double>(clock::now() - start).count();
+    }
+
+    std::string generate_text(const std::string& alphabet, const size_t size)
+    {
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<size_t> distribution(0, alphabet.size() - 1);
+        std::string text(size, ' ');
+        for (char& character : text) {
+            character = alphabet[distribution(generator)];
+        }
+        return text;
+    }
+
+    // Runs body until duration passes, returns iterations per second
+    double measure_rate(const std::chrono::milliseconds& duration, const std::function<void()>& body)
+    {
+        size_t iterations = 0;
+        const clock::time_point start = clock::now();
+        do {
+            body();
+            ++iterations;
+        } while (clock::now() - start < duration);
+        return iterations / seconds_since(start);
+    }
+
+    void bench_transform_text(json_writer& json, const bench_options& options)
+    {
+        const std::vector<std::pair<std::string, std::string>> mixes = {
+            { "single_symbol", "abcdefghijlnopqrsuvyz0123456789 " },
+            { "multi_symbol", "kmtwx" },
+            { "mixed", "abcdefghijklmnopqrstuvwxyz0123456789 " }
+        };
+        const std::vector<size_t> sizes = { 16, 256, 4096, 65536, 1048576 };
+
+        json.begin_array("transform_text");
+        for (const auto& mix : mixes) {
+            for (const size_t size : sizes) {
+                const std::string text = generate_text(mix.second, size);
+                std::vector<uint8_t> buffer(seven_segment_encoder::measure(text).size);
+                size_t checksum = 0;
+
+                const double vector_rate = measure_rate(options.duration / 4, [&text, &checksum]() {
+                    checksum += fpga_sender::transform_text(text).size();
+                });
+                const double buffer_rate = measure_rate(options.duration / 4, [&text, &buffer, &checksum]() {
+                    const encode_status required = seven_segment_encoder::measure(text);
+                    checksum += seven_segment_encoder::encode(text, buffer.data(), required.size).size;
+                });
+                const double font_rate = measure_rate(options.duration / 4, [&text, &buffer, &checksum]() {
+                    const glyph_font& font = *glyph_font::builtin();
+                    const encode_status required = font.measure(text);
+                    checksum += font.encode(text, buffer.data(), required.size).size;
+                });
+
+                json.begin_object();
+                json.value("mix", mix.first);
+                json.value("characters", static_cast<double>(size));
+                json.value("symbols", static_cast<double>(buffer.size()));
+                json.value("vector_characters_per_second", vector_rate * size);
+                json.value("buffer_characters_per_second", buffer_rate * size);
+                json.value("font_characters_per_second", font_rate * size);
+                json.value("checksum", static_cast<double>(checksum % 1000));
+                json.end_object();
+            }
+        }
+        json.end_array();
+    }
+
+    void bench_effect_frames(json_writer& json, const bench_options& options)
+    {
+        const std::vector<std::pair<std::string, display_effect>> effects = {
+            { "scroll", display_effect::scroll },
+            { "blink", display_effect::blink },
+            { "wipe", display_effect::wipe }
+        };
+        const std::vector<size_t> sizes = { 16, 256, 4096 };
+
+        json.begin_array("effect_frames");
+        for (const auto& effect : effects) {
+            for (const size_t size : sizes) {
+                const std::vector<uint8_t> symbols = fpga_sender::transform_text(
+                    generate_text("abcdefghijlnopqrsuvyz0123456789 ", size));
+                effect_options settings;
+                settings.effect = effect.second;
+                size_t checksum = 0;
+
+                const display_frames frames(symbols, settings);
+                const double build_rate = measure_rate(options.duration / 3, [&symbols, &settings, &checksum]() {
+                    checksum += display_frames(symbols, settings).size();
+                });
+                size_t frame_no = 0;
+                const double ring_rate = measure_rate(options.duration / 3, [&frames, &frame_no, &checksum]() {
+                    checksum += frames.frame(frame_no++)[0];
+                });
+                size_t symbol_no = 0;
+                frame_stream stream([&symbols, &symbol_no](uint8_t* read, const size_t count) {
+                    for (size_t read_no = 0; read_no < count; ++read_no) {
+                        read[read_no] = symbols[symbol_no++ % symbols.size()];
+                    }
+                }, settings);
+                const double stream_rate = measure_rate(options.duration / 3, [&stream, &checksum]() {
+                    checksum += stream.next()[0];
+                });
+
+                json.begin_object();
+                json.value("effect", effect.first);
+                json.value("symbols", static_cast<double>(symbols.size()));
+                json.value("frames", static_cast<double>(frames.size()));
+                json.value("build_frames_per_second", build_rate * frames.size());
+                json.value("ring_frames_per_second", ring_rate);
+                json.value("stream_frames_per_second", stream_rate);
+                json.value("checksum", static_cast<double>(checksum % 1000));
+                json.end_object();
+            }
+        }
+        json.end_array();
+    }
+
+    void bench_serial_write(json_writer& json, const bench_options& options)
+    {
+        json.begin_array("serial_write");
+        for (const size_t call_size : { 1, 16, 256, 4096 }) {
+            fpga_emulator emulator;
+            std::thread receiving_thread([&emulator]() { emulator.run(); });
+            {
+                const serial_device device(emulator.get_device_path(), 4000000);
+                if (!device.is_opened()) {
+                    emulator.stop();
+                    receiving_thread.join();
+                    throw std::runtime_error("Error opening emulated device");
+                }
+
+                const std::vector<uint8_t> bytes(call_size, 0x88);
+                size_t calls = 0;
+                const clock::time_point start = clock::now();
+                do {
+                    device.write_bytes(bytes.data(), bytes.size());
+                    ++calls;
+                } while (clock::now() - start < options.duration / 4);
+                const double elapsed = seconds_since(start);
+
+                json.begin_object();
+                json.value("device", "pty");
+                json.value("call_size", static_cast<double>(call_size));
+                json.value("calls_per_second", calls / elapsed);
+                json.value("bytes_per_second", calls * call_size / elapsed);
+                json.end_object();
+            }
+            emulator.stop();
+            receiving_thread.join();
+        }
+        json.end_array();
+    }
+
+    void write_percentiles(json_writer& json, std::vector<double>& deviations_us)
+    {
+        std::sort(deviations_us.begin(), deviations_us.end());
+        const auto percentile = [&deviations_us](const double fraction) {
+            if (deviations_us.empty()) {
+                return 0.0;
+            }
+            const auto index = static_cast<size_t>(fraction * static_cast<double>(deviations_us.size() - 1));
+            return deviations_us[index];
+        };
+
+        json.value("samples", static_cast<double>(deviations_us.size()));
+        json.value("p50_us", percentile(0.5));
+        json.value("p90_us", percentile(0.9));
+        json.value("p99_us", percentile(0.99));
+        json.value("p999_us", percentile(0.999));
+        json.value("max_us", percentile(1.0));
+
+        // Power-of-two microsecond buckets: [0, 1), [1, 2), [2, 4), ...
+        std::vector<size_t> histogram;
+        for (const double deviation : deviations_us) {
+            size_t bucket = 0;
+            while ((deviation >= static_cast<double>(1ull << bucket)) && (bucket < 30)) {
+                ++bucket;
+            }
+            if (histogram.size() <= bucket) {
+                histogram.resize(bucket + 1, 0);
+            }
+            ++histogram[bucket];
+        }
+        json.begin_array("histogram_log2_us");
+        for (size_t bucket = 0; bucket < histogram.size(); ++bucket) {
+            json.begin_object();
+            json.value("below_us", static_cast<double>(1ull << bucket));
+            json.value("count", static_cast<double>(histogram[bucket]));
+            json.end_object();
+        }
+        json.end_array();
+    }
+
+    void bench_tick_accuracy(json_writer& json, const bench_options& options)
+    {
+        struct tick_case {
+            std::string mode;
+            std::chrono::microseconds period;
+        };
+        const std::vector<tick_case> cases = {
+            { "condition_variable", std::chrono::microseconds(1000) },
+            { "condition_variable", std::chrono::microseconds(10000) },
+            { "realtime", std::chrono::microseconds(250) },
+            { "realtime", std::chrono::microseconds(1000) }
+        };
+
+        json.begin_array("tick_accuracy");
+        for (const tick_case& ticks : cases) {
+            fpga_emulator emulator(ticks.period);
+            std::vector<clock::time_point> arrivals;
+            arrivals.reserve(static_cast<size_t>(options.duration / ticks.period) * 2 + 16);
+            std::thread receiving_thread([&emulator, &arrivals]() {
+                emulator.run([&arrivals](const uint8_t, const clock::time_point& arrival) {
+                    arrivals.push_back(arrival);
+                });
+            });
+
+            const auto device = std::make_shared<serial_device>(emulator.get_device_path(), 4000000);
+            fpga_sender sender(device);
+            std::string error;
+            std::thread sending_thread([&sender, &ticks, &error]() {
+                try {
+                    if (ticks.mode == "realtime") {
+                        realtime_options settings;
+                        settings.period = ticks.period;
+                        sender.send_realtime("8", settings);
+                    } else {
+                        sender.send("8", ticks.period);
+                    }
+                } catch (const std::exception& e) {
+                    error = e.what();
+                }
+            });
+            std::this_thread::sleep_for(options.duration);
+            sender.stop();
+            sending_thread.join();
+            // Let last bytes arrive before statistics are taken
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            emulator.stop();
+            receiving_thread.join();
+
+            std::vector<double> deviations_us;
+            for (size_t arrival_no = 1; arrival_no < arrivals.size(); ++arrival_no) {
+                const auto period = arrivals[arrival_no] - arrivals[arrival_no - 1];
+                deviations_us.push_back(std::abs(std::chrono::duration<double, std::micro>(period - ticks.period).count()));
+            }
+
+            const emulator_statistics statistics = emulator.get_statistics();
+            json.begin_object();
+            json.value("mode", ticks.mode);
+            json.value("period_us", static_cast<double>(ticks.period.count()));
+            if (!error.empty()) {
+                json.value("error", error);
+            }
+            json.value("bytes_per_second", statistics.bytes_per_second);
+            json.value("mean_period_us", std::chrono::duration<double, std::micro>(statistics.mean_period).count());
+            json.value("drift_us", std::chrono::duration<double, std::micro>(statistics.mean_latency).count());
+            write_percentiles(json, deviations_us);
+            json.end_object();
+        }
+        json.end_array();
+    }
+
+    void print_usage(std::ostream& stream, const std::string& program)
+    {
+        stream << "Usage: " << program << " [options]\n"
+            << "Benchmarks encoding, effect frames, serial writes and tick scheduling, printing JSON results.\n\n"
+            << "  -o, --output PATH        write results to PATH instead of standard output\n"
+            << "  -f, --filter NAME        run only benchmarks whose name contains NAME\n"
+            << "  -d, --duration MS        time budget per benchmark case, default 1000\n"
+            << "  -h, --help               show this help\n";
+    }
+
+    bool parse_options(const int argc, char* argv[], bench_options& options)
+    {
+        for (int argument_no = 1; argument_no < argc; ++argument_no) {
+            const std::string argument = argv[argument_no];
+            const auto next_value = [&]() -> std::string {
+                if (argument_no + 1 >= argc) {
+                    throw std::invalid_argument("Missing value for " + argument);
+                }
+                return argv[++argument_no];
+            };
+
+            if ((argument == "-h") || (argument == "--help")) {
+                return false;
+            } else if ((argument == "-o") || (argument == "--output")) {
+                options.output_path = next_value();
+            } else if ((argument == "-f") || (argument == "--filter")) {
+                options.filter = next_value();
+            } else if ((argument == "-d") || (argument == "--duration")) {
+                const std::string value = next_value();
+                try {
+                    options.duration = std::chrono::milliseconds(std::stoul(value));
+                } catch (const std::exception&) {
+                    throw std::invalid_argument("Invalid value for " + argument + ": " + value);
+                }
+                if (options.duration.count() < 4) {
+                    throw std::invalid_argument("Duration must be at least 4 ms");
+                }
+            } else {
+                throw std::invalid_argument("Unknown option " + argument);
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    bench_options options;
+    try {
+        if (!parse_options(argc, argv, options)) {
+            print_usage(std::cout, argv[0]);
+            return 0;
+        }
+    } catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << std::endl;
+        print_usage(std::cerr, argv[0]);
+        return 1;
+    }
+
+    const std::vector<std::pair<std::string, std::function<void(json_writer&, const bench_options&)>>> benchmarks = {
+        { "transform_text", bench_transform_text },
+        { "effect_frames", bench_effect_frames },
+        { "serial_write", bench_serial_write },
+        { "tick_accuracy", bench_tick_accuracy }
+    };
+
+    json_writer json;
+    json.begin_object();
+    json.value("duration_ms", static_cast<double>(options.duration.count()));
+    try {
+        for (const auto& benchmark : benchmarks) {
+            if (benchmark.first.find(options.filter) != std::string::npos) {
+                benchmark.second(json, options);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return 2;
+    }
+    json.end_object();
+
+    if (options.output_path.empty()) {
+        std::cout << json.str() << std::endl;
+    } else {
+        std::ofstream output(options.output_path, std::ios::trunc);
+        output << json.str() << std::endl;
+    }
+    return 0;
+}
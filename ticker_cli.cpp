@@ -0,0 +1,710 @@
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include "fpga_sender.h"
+#include "file_tail_source.h"
+#include "metrics_dumper.h"
+#include "ticker_fanout.h"
+#include "control_server.h"
+#include "serial_device.h"
+#include "device_watcher.h"
+#include "byte_trace.h"
+
+#ifdef __unix__
+#include <csignal>
+#include <fcntl.h>
+#include <signal.h>
+#include <syslog.h>
+#include <unistd.h>
+#include <fstream>
+#endif
+
+using namespace fpga_ticker_client;
+
+namespace {
+    enum exit_code {
+        exit_success = 0,
+        exit_usage_error = 1,
+        exit_device_error = 2,
+        exit_send_error = 3
+    };
+
+    struct cli_options {
+        std::string device;
+        uint32_t speed = 0;
+        bool has_speed = false;
+        uint32_t period = 0;
+        bool has_period = false;
+        std::string text;
+        bool has_text = false;
+        std::string file;
+        std::string followed_file;
+        std::string font_file;
+        seven_segment_glyph fallback = { { }, 0 };
+        std::shared_ptr<const glyph_font> font = glyph_font::builtin();
+        bool frames = false;
+        bool has_effect = false;
+        effect_options effect;
+        bool upload = false;
+        bool acknowledged = false;
+        link_options link_settings;
+        bool realtime = false;
+        realtime_options realtime_settings;
+        missed_deadline_policy policy = missed_deadline_policy::skip;
+        serial_options port_settings;
+        bool reconnect = false;
+        bool daemon = false;
+        std::string pid_file;
+        std::string metrics_file;
+        uint32_t metrics_interval = 1000;
+        std::vector<fanout_ticker> tickers;
+        std::string control_path;
+        std::string trace_file;
+        uint32_t trace_size = byte_trace_recorder::default_capacity >> 20;
+    };
+
+    bool daemonized = false;
+
+    void print_usage(std::ostream& stream, const std::string& program)
+    {
+        stream << "Usage: " << program << " -d DEVICE -b BAUD -p PERIOD [options]\n"
+            << "       " << program << " --ticker DEVICE:BAUD:PERIOD:TEXT [--ticker ...] [options]\n"
+            << "Sends text symbol-by-symbol in 7-segment format to FPGA serial device.\n\n"
+            << "  -d, --device PATH        serial device path\n"
+            << "  -b, --baud SPEED         port speed\n"
+            << "  -p, --period PERIOD      period for each character, milliseconds (microseconds in realtime mode)\n"
+            << "  -t, --text TEXT          text to send, read from standard input if omitted or '-'\n"
+            << "  -f, --file PATH          stream text file of any size instead of text, encoded as it is sent\n"
+            << "  -F, --follow PATH        send contents of small file and follow its changes like tail -f\n"
+            << "      --ticker SPEC        add ticker driven from shared event loop, period in milliseconds\n"
+            << "      --control PATH       serve list, start, stop and batched ticker updates on Unix socket PATH\n"
+            << "      --font PATH          add or replace glyphs with those of font file, text is UTF-8\n"
+            << "      --fallback SYMBOLS   show characters font has no glyph for as SYMBOLS, such as \"6\"\n"
+            << "  -w, --digits N           send whole N-digit frames each tick to multi-digit display\n"
+            << "      --effect NAME        frame effect: scroll (default), blink or wipe\n"
+            << "      --hold N             frames a blinking or wiped page stays in one state, default 4\n"
+            << "      --low-latency        request low latency mode from serial driver\n"
+            << "      --no-flow-control    disable hardware and software flow control\n"
+            << "      --catch-up           send missed characters in a burst instead of skipping them\n"
+            << "      --reconnect          wait for device that went away and resume text where it stopped\n"
+            << "  -U, --upload             upload text once to board that loops it by itself, with --follow\n"
+            << "                           upload again on every change\n"
+            << "  -A, --ack                send checksummed packets the board acknowledges, resending lost ones\n"
+            << "      --ack-window N       packets sent ahead of acknowledgements, 1..127, default 8\n"
+            << "      --ack-timeout MS     resend packets unacknowledged for MS milliseconds, default 200\n"
+            << "  -r, --realtime           realtime mode with microsecond period\n"
+            << "      --nanosleep          drive realtime ticks with clock_nanosleep instead of timerfd\n"
+            << "      --fifo-priority N    run sending thread with SCHED_FIFO priority N\n"
+            << "      --cpu N              pin sending thread to CPU N\n"
+            << "      --lock-memory        lock process memory with mlockall\n"
+            << "  -D, --daemon             detach and run in background until SIGTERM\n"
+            << "      --pid-file PATH      write process id to PATH in daemon mode\n"
+            << "      --metrics-file PATH  periodically write sender metrics to PATH in Prometheus text format\n"
+            << "      --metrics-interval MS  metrics dump interval, default 1000\n"
+            << "      --trace PATH         record every byte written with its timestamp to ring file PATH\n"
+            << "      --trace-size MB      trace ring size, oldest writes are overwritten, default 64\n"
+            << "  -h, --help               show this help\n";
+    }
+
+    uint32_t parse_number(const std::string& option, const std::string& value)
+    {
+        size_t parsed_length = 0;
+        unsigned long number;
+        try {
+            number = std::stoul(value, &parsed_length, 10);
+        } catch (const std::exception&) {
+            parsed_length = 0;
+        }
+        if ((parsed_length == 0) || (parsed_length != value.size()) || (number > UINT32_MAX)) {
+            throw std::invalid_argument("Invalid value for " + option + ": " + value);
+        }
+        return static_cast<uint32_t>(number);
+    }
+
+    fanout_ticker parse_ticker(const std::string& option, const std::string& specification)
+    {
+        std::vector<std::string> fields;
+        size_t field_start = 0;
+        while (fields.size() < 3) {
+            const size_t separator = specification.find(':', field_start);
+            if (separator == std::string::npos) {
+                throw std::invalid_argument("Invalid value for " + option + ": " + specification);
+            }
+            fields.push_back(specification.substr(field_start, separator - field_start));
+            field_start = separator + 1;
+        }
+
+        fanout_ticker ticker;
+        ticker.device_path = fields[0];
+        ticker.speed = parse_number(option, fields[1]);
+        ticker.period = std::chrono::milliseconds(parse_number(option, fields[2]));
+        ticker.text = specification.substr(field_start);
+        return ticker;
+    }
+
+    bool parse_options(const int argc, char* argv[], cli_options& options)
+    {
+        for (int argument_no = 1; argument_no < argc; ++argument_no) {
+            const std::string argument = argv[argument_no];
+            const auto next_value = [&]() -> std::string {
+                if (argument_no + 1 >= argc) {
+                    throw std::invalid_argument("Missing value for " + argument);
+                }
+                return argv[++argument_no];
+            };
+
+            if ((argument == "-h") || (argument == "--help")) {
+                return false;
+            } else if ((argument == "-d") || (argument == "--device")) {
+                options.device = next_value();
+            } else if ((argument == "-b") || (argument == "--baud")) {
+                options.speed = parse_number(argument, next_value());
+                options.has_speed = true;
+            } else if ((argument == "-p") || (argument == "--period")) {
+                options.period = parse_number(argument, next_value());
+                options.has_period = true;
+            } else if ((argument == "-t") || (argument == "--text")) {
+                options.text = next_value();
+                options.has_text = options.text != "-";
+            } else if ((argument == "-f") || (argument == "--file")) {
+                options.file = next_value();
+            } else if ((argument == "-F") || (argument == "--follow")) {
+                options.followed_file = next_value();
+            } else if ((argument == "-w") || (argument == "--digits")) {
+                options.effect.digits = parse_number(argument, next_value());
+                options.frames = true;
+                if ((options.effect.digits == 0) || (options.effect.digits > effect_options::max_digits)) {
+                    throw std::invalid_argument("Display must have 1.." + std::to_string(effect_options::max_digits)
+                        + " digits");
+                }
+            } else if (argument == "--effect") {
+                options.effect.effect = effect_options::parse_effect(next_value());
+                options.has_effect = true;
+            } else if (argument == "--hold") {
+                options.effect.hold_frames = parse_number(argument, next_value());
+                options.has_effect = true;
+                if (options.effect.hold_frames == 0) {
+                    throw std::invalid_argument("Hold must last at least one frame");
+                }
+            } else if (argument == "--trace") {
+                options.trace_file = next_value();
+            } else if (argument == "--trace-size") {
+                options.trace_size = parse_number(argument, next_value());
+                if (options.trace_size == 0) {
+                    throw std::invalid_argument("Trace size must be positive");
+                }
+            } else if (argument == "--control") {
+                options.control_path = next_value();
+            } else if (argument == "--font") {
+                options.font_file = next_value();
+            } else if (argument == "--fallback") {
+                const std::string value = next_value();
+                try {
+                    options.fallback = glyph_font::parse_glyph(value);
+                } catch (const std::invalid_argument& e) {
+                    throw std::invalid_argument("Invalid value for " + argument + ": " + e.what());
+                }
+            } else if (argument == "--ticker") {
+                options.tickers.push_back(parse_ticker(argument, next_value()));
+            } else if (argument == "--low-latency") {
+                options.port_settings.low_latency = true;
+            } else if (argument == "--no-flow-control") {
+                options.port_settings.disable_flow_control = true;
+            } else if (argument == "--catch-up") {
+                options.policy = missed_deadline_policy::catch_up;
+            } else if (argument == "--reconnect") {
+                options.reconnect = true;
+            } else if ((argument == "-U") || (argument == "--upload")) {
+                options.upload = true;
+            } else if ((argument == "-A") || (argument == "--ack")) {
+                options.acknowledged = true;
+            } else if (argument == "--ack-window") {
+                options.link_settings.window = parse_number(argument, next_value());
+                if ((options.link_settings.window == 0) || (options.link_settings.window > 127)) {
+                    throw std::invalid_argument("Acknowledgement window must be 1..127 packets");
+                }
+            } else if (argument == "--ack-timeout") {
+                options.link_settings.timeout = std::chrono::milliseconds(parse_number(argument, next_value()));
+                if (options.link_settings.timeout.count() == 0) {
+                    throw std::invalid_argument("Acknowledgement timeout must be positive");
+                }
+            } else if ((argument == "-r") || (argument == "--realtime")) {
+                options.realtime = true;
+            } else if (argument == "--nanosleep") {
+                options.realtime_settings.use_timerfd = false;
+            } else if (argument == "--fifo-priority") {
+                options.realtime_settings.fifo_priority = static_cast<int>(parse_number(argument, next_value()));
+            } else if (argument == "--cpu") {
+                options.realtime_settings.cpu = static_cast<int>(parse_number(argument, next_value()));
+            } else if (argument == "--lock-memory") {
+                options.realtime_settings.lock_memory = true;
+            } else if ((argument == "-D") || (argument == "--daemon")) {
+                options.daemon = true;
+            } else if (argument == "--pid-file") {
+                options.pid_file = next_value();
+            } else if (argument == "--metrics-file") {
+                options.metrics_file = next_value();
+            } else if (argument == "--metrics-interval") {
+                options.metrics_interval = parse_number(argument, next_value());
+                if (options.metrics_interval == 0) {
+                    throw std::invalid_argument("Metrics interval must be positive");
+                }
+            } else {
+                throw std::invalid_argument("Unknown option " + argument);
+            }
+        }
+
+        if (options.tickers.empty() && (options.device.empty() || !options.has_speed || !options.has_period)) {
+            throw std::invalid_argument("Device, baud and period are required");
+        }
+        if ((!options.file.empty() || !options.followed_file.empty())
+            && (options.has_text || !options.tickers.empty())) {
+            throw std::invalid_argument("File cannot be combined with text or tickers");
+        }
+        if (!options.file.empty() && (options.realtime || !options.followed_file.empty())) {
+            throw std::invalid_argument("Streamed file cannot be combined with realtime mode or followed file");
+        }
+        if (options.upload && (options.realtime || !options.file.empty() || !options.tickers.empty())) {
+            throw std::invalid_argument("Upload cannot be combined with realtime mode, streamed file or tickers");
+        }
+        if (options.acknowledged && (options.realtime || options.upload || !options.file.empty()
+            || !options.tickers.empty())) {
+            throw std::invalid_argument(
+                "Acknowledged mode cannot be combined with realtime mode, upload, streamed file or tickers");
+        }
+        if (options.frames && (options.realtime || options.upload || options.acknowledged
+            || !options.tickers.empty())) {
+            throw std::invalid_argument(
+                "Frames cannot be combined with realtime mode, upload, acknowledged mode or tickers");
+        }
+        if (options.has_effect && !options.frames) {
+            throw std::invalid_argument("Effects need display width set with --digits");
+        }
+        if (options.reconnect && (options.realtime || options.upload || options.acknowledged || options.frames
+            || !options.file.empty() || !options.followed_file.empty() || !options.tickers.empty())) {
+            throw std::invalid_argument("Reconnecting is only supported for text sent from this process");
+        }
+        if (!options.control_path.empty() && options.tickers.empty()) {
+            throw std::invalid_argument("Control socket needs tickers");
+        }
+        if (options.upload && (options.period == 0)) {
+            throw std::invalid_argument("Uploaded period must be positive");
+        }
+        return true;
+    }
+
+    std::string read_text(std::istream& stream)
+    {
+        std::string text((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        while (!text.empty() && ((text.back() == '\n') || (text.back() == '\r'))) {
+            text.pop_back();
+        }
+        std::replace_if(text.begin(), text.end(), [](const char character) {
+            return (character == '\n') || (character == '\r') || (character == '\t');
+        }, ' ');
+        return text;
+    }
+
+    void report_error(const std::string& message)
+    {
+#ifdef __unix__
+        if (daemonized) {
+            syslog(LOG_ERR, "%s", message.c_str());
+            return;
+        }
+#endif
+        std::cerr << message << std::endl;
+    }
+
+    void send_followed(fpga_sender& sender, const cli_options& options);
+
+    void send(fpga_sender& sender, const cli_options& options)
+    {
+        if (!options.followed_file.empty()) {
+            send_followed(sender, options);
+            return;
+        }
+
+        if (options.realtime) {
+            realtime_options settings = options.realtime_settings;
+            settings.period = std::chrono::microseconds(options.period);
+            const jitter_statistics statistics = sender.send_realtime(options.text, settings, options.policy);
+            if (!daemonized) {
+                std::cout << statistics.to_string() << std::endl;
+            }
+        } else if (options.acknowledged) {
+            const link_statistics statistics = sender.send_acknowledged(options.text,
+                std::chrono::milliseconds(options.period), options.link_settings, options.policy);
+            if (!daemonized) {
+                std::cout << statistics.to_string() << std::endl;
+            }
+        } else if (options.frames && !options.file.empty()) {
+            sender.send_file_frames(options.file, std::chrono::milliseconds(options.period), options.effect,
+                options.policy);
+        } else if (options.frames) {
+            sender.send_frames(options.text, std::chrono::milliseconds(options.period), options.effect,
+                options.policy);
+        } else if (!options.file.empty()) {
+            sender.send_file(options.file, std::chrono::milliseconds(options.period), options.policy);
+        } else {
+            sender.send(options.text, std::chrono::milliseconds(options.period), options.policy);
+        }
+    }
+
+    void report_notice(const std::string& message)
+    {
+#ifdef __unix__
+        if (daemonized) {
+            syslog(LOG_NOTICE, "%s", message.c_str());
+            return;
+        }
+#endif
+        std::cout << message << std::endl;
+    }
+
+    // Sends text, and each time device fails waits for it to come back and goes on from where it stopped
+    void send_reconnecting(fpga_sender& sender, serial_device& device, device_watcher& watcher,
+        const cli_options& options)
+    {
+        bool resuming = false;
+        while (true) {
+            try {
+                if (resuming) {
+                    sender.resume();
+                } else {
+                    send(sender, options);
+                }
+                return;
+            } catch (const device_lost_error& e) {
+                report_error("Lost device " + options.device + ": " + e.what() + ", waiting for it to come back");
+            }
+
+            if (!watcher.reopen(device)) {
+                return;
+            }
+            report_notice("Device " + options.device + " is back, resuming");
+            // Text sent with zero period has no position to resume and starts over
+            resuming = sender.can_resume();
+        }
+    }
+
+    void send_followed(fpga_sender& sender, const cli_options& options)
+    {
+        file_tail_source source(options.followed_file, options.font);
+        cli_options followed_options = options;
+        followed_options.text = source.get_text();
+        followed_options.followed_file.clear();
+
+        std::thread following_thread([&source, &sender]() {
+            try {
+                source.run([&sender](std::unique_ptr<frame_exchange::frame> characters) {
+                    sender.splice_frame(std::move(characters));
+                }, [](const std::string& error) {
+                    report_error("Error following file: " + error);
+                });
+            } catch (const std::exception& e) {
+                report_error(std::string("Error following file: ") + e.what());
+            }
+        });
+        try {
+            send(sender, followed_options);
+        } catch (...) {
+            source.stop();
+            following_thread.join();
+            throw;
+        }
+        source.stop();
+        following_thread.join();
+    }
+
+#ifdef __unix__
+    sigset_t stop_signal_set()
+    {
+        sigset_t stop_signals;
+        sigemptyset(&stop_signals);
+        sigaddset(&stop_signals, SIGINT);
+        sigaddset(&stop_signals, SIGTERM);
+        sigaddset(&stop_signals, SIGHUP);
+        return stop_signals;
+    }
+
+    void daemonize(const cli_options& options)
+    {
+        const pid_t child = fork();
+        if (child == -1) {
+            throw std::runtime_error("Error forking daemon: " + std::to_string(errno));
+        } else if (child != 0) {
+            _exit(exit_success);
+        }
+
+        if (setsid() == -1) {
+            throw std::runtime_error("Error creating session: " + std::to_string(errno));
+        }
+        if (chdir("/") == -1) {
+            throw std::runtime_error("Error changing directory: " + std::to_string(errno));
+        }
+
+        const int null_device = open("/dev/null", O_RDWR);
+        if (null_device != -1) {
+            dup2(null_device, STDIN_FILENO);
+            dup2(null_device, STDOUT_FILENO);
+            dup2(null_device, STDERR_FILENO);
+            if (null_device > STDERR_FILENO) {
+                close(null_device);
+            }
+        }
+
+        openlog("ticker-cli", LOG_PID, LOG_DAEMON);
+        daemonized = true;
+
+        if (!options.pid_file.empty()) {
+            std::ofstream pid_stream(options.pid_file, std::ios::trunc);
+            pid_stream << getpid() << std::endl;
+        }
+    }
+
+    int run(const std::function<void()>& routine, const std::function<void()>& stop, const cli_options& options)
+    {
+        // Blocked by main() before any thread was started, so only this wait takes them
+        const sigset_t stop_signals = stop_signal_set();
+        int result = exit_success;
+        std::thread sending_thread([&routine, &result]() {
+            try {
+                routine();
+            } catch (const std::exception& e) {
+                report_error(std::string("Error sending data to device: ") + e.what());
+                result = exit_send_error;
+            }
+            // Wake up signal waiter when sending ended by itself
+            kill(getpid(), SIGTERM);
+        });
+
+        int signal_number;
+        sigwait(&stop_signals, &signal_number);
+        stop();
+        sending_thread.join();
+
+        if (daemonized && !options.pid_file.empty()) {
+            unlink(options.pid_file.c_str());
+        }
+        return result;
+    }
+#else
+    int run(const std::function<void()>& routine, const std::function<void()>&, const cli_options&)
+    {
+        try {
+            routine();
+        } catch (const std::exception& e) {
+            report_error(std::string("Error sending data to device: ") + e.what());
+            return exit_send_error;
+        }
+        return exit_success;
+    }
+#endif
+
+    int run_upload(fpga_sender& sender, const cli_options& options)
+    {
+        const std::chrono::microseconds period = std::chrono::milliseconds(options.period);
+        try {
+            if (options.followed_file.empty()) {
+                sender.upload(options.text, period);
+                return exit_success;
+            }
+
+            file_tail_source source(options.followed_file, options.font);
+            sender.upload(source.get_text(), period);
+            return run([&sender, &source, &period] {
+                source.run([&sender, &period](std::unique_ptr<frame_exchange::frame> characters) {
+                    sender.upload(*characters, period);
+                }, [](const std::string& error) {
+                    report_error("Error following file: " + error);
+                });
+            }, [&source] { source.stop(); }, options);
+        } catch (const std::exception& e) {
+            report_error(std::string("Error uploading text: ") + e.what());
+            return exit_send_error;
+        }
+    }
+
+    int run_fanout(const cli_options& options, const std::shared_ptr<byte_trace_recorder>& trace)
+    {
+        std::unique_ptr<ticker_fanout> fanout;
+        std::unique_ptr<control_server> control;
+        try {
+            fanout = std::make_unique<ticker_fanout>();
+            for (fanout_ticker ticker : options.tickers) {
+                ticker.port_settings = options.port_settings;
+                ticker.font = options.font;
+                ticker.trace = trace;
+                fanout->add_ticker(ticker);
+            }
+            if (!options.control_path.empty()) {
+                control = std::make_unique<control_server>(options.control_path, *fanout);
+            }
+        } catch (const std::exception& e) {
+            report_error(e.what());
+            return exit_device_error;
+        }
+
+        const int result = run([&fanout, &control] {
+            std::thread control_thread;
+            if (control) {
+                control_thread = std::thread([&control] {
+                    try {
+                        control->run();
+                    } catch (const std::exception& e) {
+                        report_error(std::string("Error serving control socket: ") + e.what());
+                    }
+                });
+            }
+            try {
+                fanout->run();
+            } catch (...) {
+                if (control) {
+                    control->stop();
+                    control_thread.join();
+                }
+                throw;
+            }
+            if (control) {
+                control->stop();
+                control_thread.join();
+            }
+        }, [&fanout] { fanout->stop(); }, options);
+        for (const fanout_ticker_status& status : fanout->get_status()) {
+            const std::string summary = status.device_path + ": " + std::to_string(status.bytes_sent) + " sent, "
+                + std::to_string(status.superseded_characters) + " superseded"
+                + (status.failed ? ", failed: " + status.error : "");
+            if (status.failed) {
+                report_error(summary);
+            } else if (!daemonized) {
+                std::cout << summary << std::endl;
+            }
+        }
+        return result;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    cli_options options;
+    std::shared_ptr<byte_trace_recorder> trace;
+    try {
+        if (!parse_options(argc, argv, options)) {
+            print_usage(std::cout, argv[0]);
+            return exit_success;
+        }
+    } catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << std::endl;
+        print_usage(std::cerr, argv[0]);
+        return exit_usage_error;
+    }
+
+    if (options.tickers.empty() && options.file.empty() && options.followed_file.empty() && !options.has_text) {
+        options.text = read_text(std::cin);
+    }
+#ifdef __unix__
+    // Inherited by every thread created from now on, including those of trace, metrics and sessions
+    const sigset_t stop_signals = stop_signal_set();
+    pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+#endif
+
+    try {
+        if (!options.font_file.empty() || (options.fallback.length != 0)) {
+            auto font = options.font_file.empty() ? std::make_shared<glyph_font>()
+                : std::make_shared<glyph_font>(options.font_file);
+            if (options.fallback.length != 0) {
+                font->set_fallback(options.fallback);
+            }
+            options.font = font;
+        }
+
+        // Created before detaching so that relative trace path is kept
+        if (!options.trace_file.empty()) {
+            trace = std::make_shared<byte_trace_recorder>(options.trace_file,
+                static_cast<size_t>(options.trace_size) << 20);
+        }
+
+        // Fail early, before detaching, on text that cannot be shown
+        if (options.tickers.empty() && options.file.empty() && options.followed_file.empty()
+            && fpga_sender::transform_text(options.text, *options.font).empty()) {
+            throw std::runtime_error("Text to send is empty");
+        }
+        for (const fanout_ticker& ticker : options.tickers) {
+            if (fpga_sender::transform_text(ticker.text, *options.font).empty()) {
+                throw std::runtime_error("Text to send to " + ticker.device_path + " is empty");
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return exit_usage_error;
+    }
+
+    if (options.daemon) {
+#ifdef __unix__
+        try {
+            daemonize(options);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return exit_usage_error;
+        }
+#else
+        std::cerr << "Daemon mode is not supported on this platform" << std::endl;
+        return exit_usage_error;
+#endif
+    }
+
+    if (!options.tickers.empty()) {
+        return run_fanout(options, trace);
+    }
+
+    const auto device = std::make_shared<serial_device>(options.device, options.speed, options.port_settings);
+    if (!device->is_opened()) {
+        report_error("Error opening device " + options.device);
+        return exit_device_error;
+    }
+    if (device->get_applied_speed() != options.speed) {
+        report_error("Requested port speed " + std::to_string(options.speed) + ", driver applied "
+            + std::to_string(device->get_applied_speed()));
+    }
+    if (trace) {
+        device->attach_trace(trace);
+    }
+
+    fpga_sender sender(device, options.font);
+    if (options.upload) {
+        return run_upload(sender, options);
+    }
+
+    std::unique_ptr<metrics_dumper> dumper;
+    if (!options.metrics_file.empty()) {
+        const std::string labels = "device=\"" + options.device + "\"";
+        dumper = std::make_unique<metrics_dumper>(options.metrics_file,
+            std::chrono::milliseconds(options.metrics_interval), [&sender, labels] {
+                return sender.get_metrics().to_prometheus(labels);
+            });
+    }
+    if (options.reconnect) {
+        std::unique_ptr<device_watcher> watcher;
+        try {
+            watcher = std::make_unique<device_watcher>(options.device);
+        } catch (const std::exception& e) {
+            report_error(e.what());
+            return exit_device_error;
+        }
+        return run([&sender, &device, &watcher, &options] {
+            send_reconnecting(sender, *device, *watcher, options);
+        }, [&sender, &watcher] {
+            watcher->cancel();
+            sender.stop();
+        }, options);
+    }
+    return run([&sender, &options] { send(sender, options); }, [&sender] { sender.stop(); }, options);
+}
@@ -0,0 +1,47 @@
+#include "ticker_cycle.h"
+#include <stdexcept>
+
+using namespace fpga_ticker_client;
+
+ticker_cycle::ticker_cycle(std::unique_ptr<frame_exchange::frame> characters)
+    : characters(std::move(characters)), current_character(0)
+{
+    if (!this->characters || this->characters->empty()) {
+        throw std::invalid_argument("Text to send is empty");
+    }
+    current_character = this->characters->size() - 1;
+}
+
+uint8_t ticker_cycle::advance(const size_t elapsed_ticks)
+{
+    if (auto next_characters = pending_characters.take()) {
+        characters = std::move(next_characters);
+        current_character = 0;
+    } else {
+        current_character = (current_character + elapsed_ticks) % characters->size();
+    }
+    return (*characters)[current_character];
+}
+
+void ticker_cycle::rewind()
+{
+    current_character = (current_character + characters->size() - 1) % characters->size();
+}
+
+void ticker_cycle::publish(std::unique_ptr<frame_exchange::frame> next_characters)
+{
+    if (!next_characters || next_characters->empty()) {
+        throw std::invalid_argument("Text to send is empty");
+    }
+    pending_characters.publish(std::move(next_characters));
+}
+
+size_t ticker_cycle::position() const
+{
+    return current_character;
+}
+
+size_t ticker_cycle::size() const
+{
+    return characters->size();
+}
@@ -0,0 +1,37 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_TICKER_CYCLE_H
+#define DDS_FPGA_TICKER_CLIENT_TICKER_CYCLE_H
+
+
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include "frame_exchange.h"
+
+namespace fpga_ticker_client {
+    /*
+     * Position of a ticker in its encoded text, shared by engines that tick many devices. Text published from any
+     * thread is taken at the next tick and starts from its first character; otherwise position moves on by the ticks
+     * elapsed, so characters of skipped ticks are never sent. All but publish() belong to the thread ticking it.
+     */
+    class ticker_cycle {
+    public:
+        explicit ticker_cycle(std::unique_ptr<frame_exchange::frame> characters);
+
+        // Moves to the character due after elapsed ticks and returns it; the first tick gives the first character
+        uint8_t advance(const size_t elapsed_ticks);
+        // Steps back before the last character, so that the next tick gives it again
+        void rewind();
+        void publish(std::unique_ptr<frame_exchange::frame> next_characters);
+
+        size_t position() const;
+        size_t size() const;
+
+    private:
+        std::unique_ptr<frame_exchange::frame> characters;
+        frame_exchange pending_characters;
+        size_t current_character;
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_TICKER_CYCLE_H
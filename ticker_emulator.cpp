@@ -0,0 +1,303 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <functional>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <stdexcept>
+#include <condition_variable>
+#include <random>
+#include "fpga_emulator.h"
+#include "upload_protocol.h"
+#include "acknowledged_link.h"
+
+#ifdef __unix__
+#include <csignal>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+using namespace fpga_ticker_client;
+
+namespace {
+    struct emulator_options {
+        std::string link_path;
+        fpga_emulator::clock::duration period = fpga_emulator::clock::duration::zero();
+        bool art = false;
+        bool quiet = false;
+        bool upload = false;
+        bool acknowledge = false;
+        // Width of emulated multi-digit display, zero shows symbols one by one
+        size_t digits = 0;
+        // Share of received bytes damaged on purpose, to exercise retransmissions
+        double error_rate = 0;
+    };
+
+    /*
+     * Board side of upload mode: loops last intact frame at its own period, independent of the host.
+     */
+    class uploaded_loop {
+    public:
+        using symbol_handler = std::function<void(const uint8_t symbol)>;
+
+        void replace(const upload_frame& frame)
+        {
+            {
+                std::lock_guard<std::mutex> lock(loop_mx);
+                current = frame;
+                ++generation;
+            }
+            loop_cv.notify_all();
+        }
+
+        void stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(loop_mx);
+                running = false;
+            }
+            loop_cv.notify_all();
+        }
+
+        void run(const symbol_handler& show)
+        {
+            std::unique_lock<std::mutex> lock(loop_mx);
+            while (running) {
+                loop_cv.wait(lock, [this] { return !running || !current.symbols.empty(); });
+                const uint64_t shown_generation = generation;
+                auto deadline = std::chrono::steady_clock::now();
+                for (size_t symbol_no = 0; running && (generation == shown_generation);
+                    symbol_no = (symbol_no + 1) % current.symbols.size()) {
+                    show(current.symbols[symbol_no]);
+                    deadline += current.period;
+                    loop_cv.wait_until(lock, deadline, [this, shown_generation] {
+                        return !running || (generation != shown_generation);
+                    });
+                }
+            }
+        }
+
+    private:
+        std::mutex loop_mx;
+        std::condition_variable loop_cv;
+        upload_frame current;
+        uint64_t generation = 0;
+        bool running = true;
+    };
+
+    void print_usage(std::ostream& stream, const std::string& program)
+    {
+        stream << "Usage: " << program << " [options]\n"
+            << "Emulates FPGA ticker board on a pseudo-terminal and decodes received 7-segment symbols.\n\n"
+            << "  -l, --link PATH          create symbolic link PATH to emulated device\n"
+            << "  -p, --period PERIOD      expected period in milliseconds, enables latency statistics\n"
+            << "      --period-us PERIOD   expected period in microseconds\n"
+            << "  -u, --upload             accept upload frames and loop them instead of showing received bytes\n"
+            << "  -k, --ack                accept acknowledged packets and reply with ACK or NAK\n"
+            << "      --error-rate PERCENT corrupt that share of received bytes before decoding\n"
+            << "  -w, --digits N           shift symbols into N-digit display and show it after every N symbols\n"
+            << "  -a, --art                draw every received symbol\n"
+            << "  -q, --quiet              print statistics only\n"
+            << "  -h, --help               show this help\n";
+    }
+
+    long parse_number(const std::string& option, const std::string& value)
+    {
+        size_t parsed_length = 0;
+        long number = -1;
+        try {
+            number = std::stol(value, &parsed_length, 10);
+        } catch (const std::exception&) {
+            parsed_length = 0;
+        }
+        if ((parsed_length == 0) || (parsed_length != value.size()) || (number < 0)) {
+            throw std::invalid_argument("Invalid value for " + option + ": " + value);
+        }
+        return number;
+    }
+
+    bool parse_options(const int argc, char* argv[], emulator_options& options)
+    {
+        for (int argument_no = 1; argument_no < argc; ++argument_no) {
+            const std::string argument = argv[argument_no];
+            const auto next_value = [&]() -> std::string {
+                if (argument_no + 1 >= argc) {
+                    throw std::invalid_argument("Missing value for " + argument);
+                }
+                return argv[++argument_no];
+            };
+
+            if ((argument == "-h") || (argument == "--help")) {
+                return false;
+            } else if ((argument == "-l") || (argument == "--link")) {
+                options.link_path = next_value();
+            } else if ((argument == "-p") || (argument == "--period")) {
+                options.period = std::chrono::milliseconds(parse_number(argument, next_value()));
+            } else if (argument == "--period-us") {
+                options.period = std::chrono::microseconds(parse_number(argument, next_value()));
+            } else if ((argument == "-u") || (argument == "--upload")) {
+                options.upload = true;
+            } else if ((argument == "-k") || (argument == "--ack")) {
+                options.acknowledge = true;
+            } else if (argument == "--error-rate") {
+                const long percent = parse_number(argument, next_value());
+                if (percent > 100) {
+                    throw std::invalid_argument("Error rate must be 0..100 percent");
+                }
+                options.error_rate = percent / 100.0;
+            } else if ((argument == "-w") || (argument == "--digits")) {
+                options.digits = static_cast<size_t>(parse_number(argument, next_value()));
+                if (options.digits == 0) {
+                    throw std::invalid_argument("Display must have at least one digit");
+                }
+            } else if ((argument == "-a") || (argument == "--art")) {
+                options.art = true;
+            } else if ((argument == "-q") || (argument == "--quiet")) {
+                options.quiet = true;
+            } else {
+                throw std::invalid_argument("Unknown option " + argument);
+            }
+        }
+        if (options.upload && options.acknowledge) {
+            throw std::invalid_argument("Upload and acknowledged modes are exclusive");
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    emulator_options options;
+    try {
+        if (!parse_options(argc, argv, options)) {
+            print_usage(std::cout, argv[0]);
+            return 0;
+        }
+    } catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << std::endl;
+        print_usage(std::cerr, argv[0]);
+        return 1;
+    }
+
+#ifdef __unix__
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+#endif
+
+    try {
+        fpga_emulator emulator(options.period, options.link_path);
+        std::cout << "Emulating FPGA on " << emulator.get_device_path() << std::endl;
+
+        // Frames arrive whole, so every digits-th symbol completes one
+        std::string display(options.digits, ' ');
+        size_t shifted_symbols = 0;
+        const auto show = [&options, &display, &shifted_symbols](const uint8_t symbol) {
+            if ((options.digits != 0) && !options.art) {
+                display.erase(0, 1);
+                display += fpga_emulator::decode_symbol(symbol);
+                if (!options.quiet && ((++shifted_symbols % options.digits) == 0)) {
+                    std::cout << '[' << display << "]\n" << std::flush;
+                }
+            } else if (options.art) {
+                std::cout << fpga_emulator::render_symbol(symbol) << std::endl;
+            } else if (!options.quiet) {
+                std::cout << fpga_emulator::decode_symbol(symbol) << std::flush;
+            }
+        };
+
+        uploaded_loop loop;
+        upload_frame_parser parser;
+        size_t accepted_frames = 0, corrupted_frames = 0;
+        link_receiver receiver;
+        size_t delivered_packets = 0, duplicate_packets = 0, rejected_packets = 0;
+        std::mt19937 generator(std::random_device{}());
+        std::bernoulli_distribution damage(options.error_rate);
+        std::thread loop_thread;
+        if (options.upload) {
+            loop_thread = std::thread([&loop, &show] { loop.run(show); });
+        }
+
+        int result = 0;
+        std::thread receiving_thread([&]() {
+            try {
+                emulator.run([&](uint8_t symbol, const fpga_emulator::clock::time_point& arrival) {
+                    if (damage(generator)) {
+                        symbol ^= 0x10;
+                    }
+                    if (options.acknowledge) {
+                        const link_receiver::status status = receiver.feed(symbol, arrival);
+                        if (status == link_receiver::status::incomplete) {
+                            return;
+                        }
+                        const auto reply = receiver.get_reply();
+                        emulator.reply(reply.data(), reply.size());
+                        if (status == link_receiver::status::delivered) {
+                            ++delivered_packets;
+                            for (const uint8_t delivered : receiver.get_payload()) {
+                                show(delivered);
+                            }
+                        } else if (status == link_receiver::status::duplicate) {
+                            ++duplicate_packets;
+                        } else {
+                            ++rejected_packets;
+                        }
+                        return;
+                    }
+                    if (!options.upload) {
+                        show(symbol);
+                        return;
+                    }
+                    switch (parser.feed(symbol, arrival)) {
+                    case upload_frame_parser::status::complete:
+                        ++accepted_frames;
+                        loop.replace(parser.get_frame());
+                        break;
+                    case upload_frame_parser::status::corrupted:
+                        ++corrupted_frames;
+                        break;
+                    case upload_frame_parser::status::incomplete:
+                        break;
+                    }
+                });
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << std::endl;
+                result = 2;
+            }
+#ifdef __unix__
+            kill(getpid(), SIGTERM);
+#endif
+        });
+
+#ifdef __unix__
+        int signal_number;
+        sigwait(&stop_signals, &signal_number);
+#endif
+        emulator.stop();
+        receiving_thread.join();
+        if (options.upload) {
+            loop.stop();
+            loop_thread.join();
+        }
+
+        if (!options.quiet && !options.art) {
+            std::cout << std::endl;
+        }
+        std::cout << emulator.get_statistics().to_string() << std::endl;
+        if (options.upload) {
+            std::cout << accepted_frames << " frames accepted, " << corrupted_frames << " corrupted, "
+                << parser.get_skipped_bytes() << " bytes outside frames" << std::endl;
+        }
+        if (options.acknowledge) {
+            std::cout << delivered_packets << " packets delivered, " << duplicate_packets << " duplicate, "
+                << rejected_packets << " damaged or out of order" << std::endl;
+        }
+        return result;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+}
@@ -0,0 +1,411 @@
+#include "ticker_fanout.h"
+#include "fpga_sender.h"
+#include "frame_exchange.h"
+#include "serial_device.h"
+#include "ticker_cycle.h"
+#include "ticker_scheduler.h"
+#include <stdexcept>
+#include <algorithm>
+#include <iterator>
+
+using namespace fpga_ticker_client;
+
+struct ticker_fanout::ticker_state {
+    ticker_state(std::unique_ptr<frame_exchange::frame> characters, const clock::duration& period)
+        : requested_period(period), requested_pause(false), period(period), paused(false), scheduled(false),
+        cycle(std::move(characters)), schedule(period), has_pending_byte(false), waiting_writable(false),
+        pending_byte(0), bytes_sent(0), superseded_characters(0), failed(false)
+    { }
+
+    size_t id = 0;
+    std::string device_path;
+    std::shared_ptr<serial_device> device;
+    std::shared_ptr<const glyph_font> font;
+    // Settings as last requested, reported in status and guarded by tickers_mx
+    std::string text;
+    clock::duration requested_period;
+    bool requested_pause;
+    // Used by event loop only, apart from text published to cycle; period is taken by schedule at the next tick
+    clock::duration period;
+    bool paused, scheduled;
+    ticker_cycle cycle;
+    ticker_scheduler schedule;
+    bool has_pending_byte, waiting_writable;
+    uint8_t pending_byte;
+    std::atomic<uint64_t> bytes_sent, superseded_characters;
+    std::atomic_bool failed;
+    std::mutex error_mx;
+    std::string error;
+};
+
+size_t ticker_fanout::add_ticker(const fanout_ticker& ticker)
+{
+    if (ticker.period <= clock::duration::zero()) {
+        throw std::invalid_argument("Ticker period must be positive");
+    }
+
+    auto characters = std::make_unique<frame_exchange::frame>(fpga_sender::transform_text(ticker.text,
+        *ticker.font));
+    if (characters->empty()) {
+        throw std::runtime_error("Text to send is empty");
+    }
+    auto state = std::make_shared<ticker_state>(std::move(characters), ticker.period);
+    state->device_path = ticker.device_path;
+    state->text = ticker.text;
+    state->font = ticker.font;
+
+    state->device = std::make_shared<serial_device>(ticker.device_path, ticker.speed, ticker.port_settings);
+    if (!state->device->is_opened()) {
+        throw std::runtime_error("Error opening device " + ticker.device_path);
+    }
+    state->device->set_non_blocking(true);
+    if (ticker.trace) {
+        state->device->attach_trace(ticker.trace);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(tickers_mx);
+        state->id = tickers.size();
+        tickers.push_back(state);
+    }
+    wake();
+    return state->id;
+}
+
+void ticker_fanout::update_text(const size_t ticker_id, const std::string& text)
+{
+    fanout_update update;
+    update.ticker_id = ticker_id;
+    update.text = text;
+    apply({ update });
+}
+
+void ticker_fanout::apply(const std::vector<fanout_update>& updates)
+{
+    std::vector<std::shared_ptr<ticker_state>> states;
+    {
+        std::lock_guard<std::mutex> lock(tickers_mx);
+        for (const fanout_update& update : updates) {
+            if (update.ticker_id >= tickers.size()) {
+                throw std::invalid_argument("No ticker " + std::to_string(update.ticker_id));
+            }
+            states.push_back(tickers[update.ticker_id]);
+        }
+    }
+
+    // Encoding is done before anything is queued, and outside the lock status readers take
+    std::vector<prepared_update> batch;
+    batch.reserve(updates.size());
+    for (size_t update_no = 0; update_no < updates.size(); ++update_no) {
+        const fanout_update& update = updates[update_no];
+        prepared_update prepared = { update.ticker_id, nullptr, update.period, update.paused };
+        if (update.period && (*update.period <= clock::duration::zero())) {
+            throw std::invalid_argument("Ticker period must be positive");
+        }
+        if (update.text) {
+            prepared.characters = std::make_unique<frame_exchange::frame>(
+                fpga_sender::transform_text(*update.text, *states[update_no]->font));
+            if (prepared.characters->empty()) {
+                throw std::runtime_error("Text to send is empty");
+            }
+        }
+        batch.push_back(std::move(prepared));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(tickers_mx);
+        for (size_t update_no = 0; update_no < updates.size(); ++update_no) {
+            const fanout_update& update = updates[update_no];
+            ticker_state& state = *states[update_no];
+            if (update.text) {
+                state.text = *update.text;
+            }
+            if (update.period) {
+                state.requested_period = *update.period;
+            }
+            if (update.paused) {
+                state.requested_pause = *update.paused;
+            }
+        }
+        std::move(batch.begin(), batch.end(), std::back_inserter(pending_updates));
+    }
+    wake();
+}
+
+std::vector<fanout_ticker_status> ticker_fanout::get_status() const
+{
+    std::lock_guard<std::mutex> lock(tickers_mx);
+    std::vector<fanout_ticker_status> result;
+    result.reserve(tickers.size());
+    for (const auto& ticker : tickers) {
+        std::lock_guard<std::mutex> error_lock(ticker->error_mx);
+        result.push_back({ ticker->id, ticker->device_path, ticker->text, ticker->requested_period,
+            ticker->requested_pause, ticker->bytes_sent, ticker->superseded_characters, ticker->failed,
+            ticker->error });
+    }
+    return result;
+}
+
+ticker_fanout::clock::time_point ticker_fanout::tick(ticker_state& ticker, const clock::time_point& now) const
+{
+    const size_t elapsed_ticks = ticker.schedule.advance(now);
+    if (ticker.period != ticker.schedule.get_period()) {
+        ticker.schedule.set_period(ticker.period, now);
+    }
+
+    if (ticker.has_pending_byte) {
+        ++ticker.superseded_characters;
+    }
+    ticker.pending_byte = ticker.cycle.advance(elapsed_ticks);
+    ticker.has_pending_byte = true;
+    flush(ticker);
+
+    return ticker.schedule.next_deadline();
+}
+
+#ifdef __linux__
+#include <cerrno>
+#include <ctime>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace {
+    const uint64_t timer_key = 0, wake_key = 1, first_ticker_key = 2;
+    const int max_events = 64;
+}
+
+ticker_fanout::ticker_fanout() : epoll(-1), timer(-1), wake_event(-1), running(true)
+{
+    epoll = epoll_create1(EPOLL_CLOEXEC);
+    timer = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    wake_event = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    struct epoll_event timer_event = {}, wake_event_settings = {};
+    timer_event.events = EPOLLIN;
+    timer_event.data.u64 = timer_key;
+    wake_event_settings.events = EPOLLIN;
+    wake_event_settings.data.u64 = wake_key;
+    if ((epoll == -1) || (timer == -1) || (wake_event == -1)
+        || (epoll_ctl(epoll, EPOLL_CTL_ADD, timer, &timer_event) == -1)
+        || (epoll_ctl(epoll, EPOLL_CTL_ADD, wake_event, &wake_event_settings) == -1)) {
+        const int error = errno;
+        for (const int descriptor : { epoll, timer, wake_event }) {
+            if (descriptor != -1) {
+                close(descriptor);
+            }
+        }
+        throw std::runtime_error("Error creating fan-out event loop: " + std::to_string(error));
+    }
+}
+
+ticker_fanout::~ticker_fanout()
+{
+    close(epoll);
+    close(timer);
+    close(wake_event);
+}
+
+void ticker_fanout::run()
+{
+    std::vector<std::shared_ptr<ticker_state>> active_tickers;
+    deadline_queue deadlines;
+    struct epoll_event events[max_events];
+
+    adopt_tickers(active_tickers, deadlines);
+    adopt_updates(active_tickers, deadlines);
+    while (running) {
+        arm_timer(deadlines);
+        const int event_count = epoll_wait(epoll, events, max_events, -1);
+        if (event_count == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Error waiting for fan-out events: " + std::to_string(errno));
+        }
+
+        for (int event_no = 0; event_no < event_count; ++event_no) {
+            const uint64_t key = events[event_no].data.u64;
+            if (key == timer_key) {
+                uint64_t expirations;
+                (void)!read(timer, &expirations, sizeof(expirations));
+            } else if (key == wake_key) {
+                uint64_t wakeups;
+                (void)!read(wake_event, &wakeups, sizeof(wakeups));
+                adopt_tickers(active_tickers, deadlines);
+                adopt_updates(active_tickers, deadlines);
+            } else {
+                ticker_state& ticker = *active_tickers[key - first_ticker_key];
+                if (!ticker.failed) {
+                    flush(ticker);
+                }
+            }
+        }
+
+        const clock::time_point now = clock::now();
+        while (!deadlines.empty() && (deadlines.top().first <= now)) {
+            const deadline due = deadlines.top();
+            deadlines.pop();
+            ticker_state& ticker = *active_tickers[due.second];
+            if (!ticker.failed && !ticker.paused) {
+                deadlines.emplace(tick(ticker, now), due.second);
+            } else {
+                ticker.scheduled = false;
+            }
+        }
+    }
+}
+
+void ticker_fanout::stop()
+{
+    running = false;
+    wake();
+}
+
+void ticker_fanout::wake() const
+{
+    const uint64_t increment = 1;
+    (void)!write(wake_event, &increment, sizeof(increment));
+}
+
+void ticker_fanout::adopt_tickers(std::vector<std::shared_ptr<ticker_state>>& active_tickers,
+    deadline_queue& deadlines)
+{
+    std::lock_guard<std::mutex> lock(tickers_mx);
+    const clock::time_point now = clock::now();
+    while (active_tickers.size() < tickers.size()) {
+        const std::shared_ptr<ticker_state>& ticker = tickers[active_tickers.size()];
+        struct epoll_event device_event = {};
+        device_event.events = 0;
+        device_event.data.u64 = first_ticker_key + ticker->id;
+        if (epoll_ctl(epoll, EPOLL_CTL_ADD, ticker->device->native_handle(), &device_event) == -1) {
+            fail(*ticker, "Error watching device: " + std::to_string(errno));
+        } else {
+            ticker->schedule.restart(now);
+            deadlines.emplace(now, ticker->id);
+            ticker->scheduled = true;
+        }
+        active_tickers.push_back(ticker);
+    }
+}
+
+void ticker_fanout::adopt_updates(std::vector<std::shared_ptr<ticker_state>>& active_tickers,
+    deadline_queue& deadlines)
+{
+    std::vector<prepared_update> updates;
+    {
+        std::lock_guard<std::mutex> lock(tickers_mx);
+        updates.swap(pending_updates);
+    }
+
+    // Whole batches are applied within one pass of the loop, before any ticker ticks again
+    const clock::time_point now = clock::now();
+    std::vector<prepared_update> postponed;
+    for (prepared_update& update : updates) {
+        // Ticker added after this pass adopted new ones, its updates wait for the wakeup adding it raised
+        if (update.ticker_id >= active_tickers.size()) {
+            postponed.push_back(std::move(update));
+            continue;
+        }
+        ticker_state& ticker = *active_tickers[update.ticker_id];
+        if (update.characters) {
+            ticker.cycle.publish(std::move(update.characters));
+        }
+        if (update.period) {
+            ticker.period = *update.period;
+        }
+        if (update.paused) {
+            ticker.paused = *update.paused;
+            if (!ticker.paused && !ticker.scheduled && !ticker.failed) {
+                ticker.schedule.restart(now);
+                deadlines.emplace(now, ticker.id);
+                ticker.scheduled = true;
+            }
+        }
+    }
+    if (!postponed.empty()) {
+        std::lock_guard<std::mutex> lock(tickers_mx);
+        pending_updates.insert(pending_updates.begin(), std::make_move_iterator(postponed.begin()),
+            std::make_move_iterator(postponed.end()));
+    }
+}
+
+void ticker_fanout::arm_timer(const deadline_queue& deadlines) const
+{
+    struct itimerspec timer_settings = {};
+    if (!deadlines.empty()) {
+        const auto deadline_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            deadlines.top().first.time_since_epoch()).count();
+        timer_settings.it_value.tv_sec = static_cast<time_t>(deadline_ns / 1000000000);
+        // Zero it_value would disarm timer instead of firing immediately
+        timer_settings.it_value.tv_nsec = std::max<long>(static_cast<long>(deadline_ns % 1000000000), 1);
+    }
+    timerfd_settime(timer, TFD_TIMER_ABSTIME, &timer_settings, nullptr);
+}
+
+void ticker_fanout::flush(ticker_state& ticker) const
+{
+    try {
+        if (ticker.has_pending_byte && (ticker.device->write_available(&ticker.pending_byte, 1) == 1)) {
+            ticker.has_pending_byte = false;
+            ++ticker.bytes_sent;
+        }
+    } catch (const std::exception& e) {
+        fail(ticker, e.what());
+        return;
+    }
+
+    if (ticker.has_pending_byte != ticker.waiting_writable) {
+        struct epoll_event device_event = {};
+        device_event.events = ticker.has_pending_byte ? static_cast<uint32_t>(EPOLLOUT) : 0;
+        device_event.data.u64 = first_ticker_key + ticker.id;
+        if (epoll_ctl(epoll, EPOLL_CTL_MOD, ticker.device->native_handle(), &device_event) == -1) {
+            fail(ticker, "Error watching device: " + std::to_string(errno));
+            return;
+        }
+        ticker.waiting_writable = ticker.has_pending_byte;
+    }
+}
+
+void ticker_fanout::fail(ticker_state& ticker, const std::string& error) const
+{
+    epoll_ctl(epoll, EPOLL_CTL_DEL, ticker.device->native_handle(), nullptr);
+    std::lock_guard<std::mutex> lock(ticker.error_mx);
+    ticker.error = error;
+    ticker.failed = true;
+}
+
+#else
+ticker_fanout::ticker_fanout() : epoll(-1), timer(-1), wake_event(-1), running(false)
+{
+    throw std::runtime_error("Fan-out engine is only supported on Linux");
+}
+
+ticker_fanout::~ticker_fanout() = default;
+
+void ticker_fanout::run()
+{ }
+
+void ticker_fanout::stop()
+{ }
+
+void ticker_fanout::wake() const
+{ }
+
+void ticker_fanout::adopt_tickers(std::vector<std::shared_ptr<ticker_state>>&, deadline_queue&)
+{ }
+
+void ticker_fanout::adopt_updates(std::vector<std::shared_ptr<ticker_state>>&, deadline_queue&)
+{ }
+
+void ticker_fanout::arm_timer(const deadline_queue&) const
+{ }
+
+void ticker_fanout::flush(ticker_state&) const
+{ }
+
+void ticker_fanout::fail(ticker_state&, const std::string&) const
+{ }
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_TICKER_FANOUT_H
+#define DDS_FPGA_TICKER_CLIENT_TICKER_FANOUT_H
+
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <queue>
+#include <optional>
+#include <utility>
+#include <functional>
+#include <cstdint>
+#include "serial_device.h"
+#include "frame_exchange.h"
+#include "glyph_font.h"
+#include "byte_trace.h"
+
+namespace fpga_ticker_client {
+    struct fanout_ticker {
+        std::string device_path;
+        uint32_t speed;
+        std::string text;
+        std::chrono::steady_clock::duration period;
+        serial_options port_settings;
+        std::shared_ptr<const glyph_font> font = glyph_font::builtin();
+        std::shared_ptr<byte_trace_recorder> trace;
+    };
+
+    // Changes of one ticker, fields left empty stay as they are
+    struct fanout_update {
+        size_t ticker_id = 0;
+        std::optional<std::string> text;
+        std::optional<std::chrono::steady_clock::duration> period;
+        std::optional<bool> paused;
+    };
+
+    struct fanout_ticker_status {
+        size_t id;
+        std::string device_path;
+        std::string text;
+        std::chrono::steady_clock::duration period;
+        bool paused;
+        uint64_t bytes_sent;
+        uint64_t superseded_characters; // characters replaced by next one while port was not writable
+        bool failed;
+        std::string error;
+    };
+
+    /*
+     * Drives many serial tickers from one epoll loop: deadlines are kept in a min-heap behind a single timerfd
+     * and devices are written without blocking, so a stalled port only loses its own characters.
+     */
+    class ticker_fanout {
+    public:
+        ticker_fanout();
+        ~ticker_fanout();
+        ticker_fanout(const ticker_fanout&) = delete;
+        ticker_fanout& operator=(const ticker_fanout&) = delete;
+
+        // Opens device and schedules ticker, returns its id; may be called while running
+        size_t add_ticker(const fanout_ticker& ticker);
+        void update_text(const size_t ticker_id, const std::string& text);
+        /*
+         * Applies all updates at once: they are checked and encoded first, so a bad one rejects the whole batch,
+         * then taken by the event loop in a single pass. Each ticker switches at its next tick.
+         */
+        void apply(const std::vector<fanout_update>& updates);
+        std::vector<fanout_ticker_status> get_status() const;
+
+        // Runs until stopped; stop() called before run() makes it return right away, so it runs at most once
+        void run();
+        void stop();
+
+    private:
+        struct ticker_state;
+        using clock = std::chrono::steady_clock;
+        using deadline = std::pair<clock::time_point, size_t>;
+        using deadline_queue = std::priority_queue<deadline, std::vector<deadline>, std::greater<deadline>>;
+        struct prepared_update {
+            size_t ticker_id;
+            std::unique_ptr<frame_exchange::frame> characters;
+            std::optional<clock::duration> period;
+            std::optional<bool> paused;
+        };
+
+        void wake() const;
+        void adopt_tickers(std::vector<std::shared_ptr<ticker_state>>& active_tickers, deadline_queue& deadlines);
+        void adopt_updates(std::vector<std::shared_ptr<ticker_state>>& active_tickers, deadline_queue& deadlines);
+        void arm_timer(const deadline_queue& deadlines) const;
+        clock::time_point tick(ticker_state& ticker, const clock::time_point& now) const;
+        void flush(ticker_state& ticker) const;
+        void fail(ticker_state& ticker, const std::string& error) const;
+
+        int epoll, timer, wake_event;
+        std::atomic_bool running;
+        mutable std::mutex tickers_mx;
+        std::vector<std::shared_ptr<ticker_state>> tickers;
+        std::vector<prepared_update> pending_updates;
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_TICKER_FANOUT_H
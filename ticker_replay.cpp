@@ -0,0 +1,221 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include "byte_trace.h"
+#include "serial_device.h"
+
+using namespace fpga_ticker_client;
+
+namespace {
+    enum exit_code {
+        exit_success = 0,
+        exit_usage_error = 1,
+        exit_device_error = 2,
+        exit_send_error = 3
+    };
+
+    struct replay_options {
+        std::string trace_file;
+        std::string device;
+        uint32_t speed = 0;
+        bool has_speed = false;
+        uint32_t device_id = 0;
+        // Replay is this many times faster than recording, zero sends without waiting
+        double time_scale = 1;
+        serial_options port_settings;
+    };
+
+    void print_usage(std::ostream& stream, const std::string& program)
+    {
+        stream << "Usage: " << program << " TRACE [-d DEVICE -b BAUD] [options]\n"
+            << "Prints timing statistics of byte trace recorded by ticker-cli --trace, or replays it to a device\n"
+            << "with recorded timing.\n\n"
+            << "  -d, --device PATH        serial device or emulator link to replay trace to\n"
+            << "  -b, --baud SPEED         port speed\n"
+            << "  -i, --device-id N        replay writes recorded for N-th traced device, default 0\n"
+            << "  -s, --speed FACTOR       replay FACTOR times faster than recorded, 0 sends without waiting\n"
+            << "      --low-latency        request low latency mode from serial driver\n"
+            << "      --no-flow-control    disable hardware and software flow control\n"
+            << "  -h, --help               show this help\n";
+    }
+
+    uint32_t parse_number(const std::string& option, const std::string& value)
+    {
+        size_t parsed_length = 0;
+        unsigned long number;
+        try {
+            number = std::stoul(value, &parsed_length, 10);
+        } catch (const std::exception&) {
+            parsed_length = 0;
+        }
+        if ((parsed_length == 0) || (parsed_length != value.size()) || (number > UINT32_MAX)) {
+            throw std::invalid_argument("Invalid value for " + option + ": " + value);
+        }
+        return static_cast<uint32_t>(number);
+    }
+
+    double parse_factor(const std::string& option, const std::string& value)
+    {
+        size_t parsed_length = 0;
+        double factor = -1;
+        try {
+            factor = std::stod(value, &parsed_length);
+        } catch (const std::exception&) {
+            parsed_length = 0;
+        }
+        if ((parsed_length == 0) || (parsed_length != value.size()) || !(factor >= 0)) {
+            throw std::invalid_argument("Invalid value for " + option + ": " + value);
+        }
+        return factor;
+    }
+
+    bool parse_options(const int argc, char* argv[], replay_options& options)
+    {
+        for (int argument_no = 1; argument_no < argc; ++argument_no) {
+            const std::string argument = argv[argument_no];
+            const auto next_value = [&]() -> std::string {
+                if (argument_no + 1 >= argc) {
+                    throw std::invalid_argument("Missing value for " + argument);
+                }
+                return argv[++argument_no];
+            };
+
+            if ((argument == "-h") || (argument == "--help")) {
+                return false;
+            } else if ((argument == "-d") || (argument == "--device")) {
+                options.device = next_value();
+            } else if ((argument == "-b") || (argument == "--baud")) {
+                options.speed = parse_number(argument, next_value());
+                options.has_speed = true;
+            } else if ((argument == "-i") || (argument == "--device-id")) {
+                options.device_id = parse_number(argument, next_value());
+            } else if ((argument == "-s") || (argument == "--speed")) {
+                options.time_scale = parse_factor(argument, next_value());
+            } else if (argument == "--low-latency") {
+                options.port_settings.low_latency = true;
+            } else if (argument == "--no-flow-control") {
+                options.port_settings.disable_flow_control = true;
+            } else if (!argument.empty() && (argument[0] == '-')) {
+                throw std::invalid_argument("Unknown option " + argument);
+            } else if (options.trace_file.empty()) {
+                options.trace_file = argument;
+            } else {
+                throw std::invalid_argument("Unexpected argument " + argument);
+            }
+        }
+        if (options.trace_file.empty()) {
+            throw std::invalid_argument("Trace file is required");
+        }
+        if (!options.device.empty() && !options.has_speed) {
+            throw std::invalid_argument("Port speed is required to replay trace");
+        }
+        return true;
+    }
+
+    void print_statistics(const byte_trace_reader& trace)
+    {
+        for (const trace_statistics& statistics : trace.get_statistics()) {
+            std::cout << statistics.to_string() << std::endl;
+        }
+        if (trace.get_overwritten_records() != 0) {
+            std::cout << trace.get_overwritten_records() << " oldest writes were overwritten" << std::endl;
+        }
+    }
+
+    // Writes each record when its recorded offset from the first one, scaled, has passed
+    void replay(const byte_trace_reader& trace, const serial_device& device, const replay_options& options)
+    {
+        using clock = std::chrono::steady_clock;
+
+        uint64_t records = 0, bytes = 0;
+        std::chrono::nanoseconds first_timestamp = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds lateness_sum = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds max_lateness = std::chrono::nanoseconds::zero();
+        const clock::time_point start = clock::now();
+        for (const byte_trace_record& record : trace.get_records()) {
+            if (record.device != options.device_id) {
+                continue;
+            }
+            if (records == 0) {
+                first_timestamp = record.timestamp;
+            }
+
+            if (options.time_scale > 0) {
+                const auto offset = std::chrono::nanoseconds(static_cast<int64_t>(
+                    static_cast<double>((record.timestamp - first_timestamp).count()) / options.time_scale));
+                const clock::time_point deadline = start + std::chrono::duration_cast<clock::duration>(offset);
+                std::this_thread::sleep_until(deadline);
+                const auto lateness = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - deadline);
+                lateness_sum += lateness;
+                max_lateness = std::max(max_lateness, lateness);
+            }
+            device.write_bytes(record.bytes, record.count);
+            ++records;
+            bytes += record.count;
+        }
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start);
+        std::cout << "replayed records: " << records
+            << ", bytes: " << bytes
+            << ", duration: " << elapsed.count() << " ms";
+        if ((options.time_scale > 0) && (records != 0)) {
+            std::cout << ", mean lateness: "
+                << std::chrono::duration_cast<std::chrono::microseconds>(lateness_sum).count()
+                    / static_cast<int64_t>(records) << " us"
+                << ", max lateness: " << std::chrono::duration_cast<std::chrono::microseconds>(max_lateness).count()
+                << " us";
+        }
+        std::cout << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    replay_options options;
+    try {
+        if (!parse_options(argc, argv, options)) {
+            print_usage(std::cout, argv[0]);
+            return exit_success;
+        }
+    } catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << std::endl;
+        print_usage(std::cerr, argv[0]);
+        return exit_usage_error;
+    }
+
+    std::unique_ptr<byte_trace_reader> trace;
+    try {
+        trace = std::make_unique<byte_trace_reader>(options.trace_file);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return exit_usage_error;
+    }
+    if (options.device.empty()) {
+        print_statistics(*trace);
+        return exit_success;
+    }
+    if (options.device_id >= trace->get_devices().size()) {
+        std::cerr << "Trace has no device " << options.device_id << std::endl;
+        return exit_usage_error;
+    }
+
+    serial_device device(options.device, options.speed, options.port_settings);
+    if (!device.is_opened()) {
+        std::cerr << "Error opening device " << options.device << std::endl;
+        return exit_device_error;
+    }
+    try {
+        std::cout << "Replaying " << trace->get_devices()[options.device_id] << " to " << options.device
+            << std::endl;
+        replay(*trace, device, options);
+    } catch (const std::exception& e) {
+        std::cerr << "Error replaying trace: " << e.what() << std::endl;
+        return exit_send_error;
+    }
+    return exit_success;
+}
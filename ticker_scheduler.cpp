@@ -0,0 +1,69 @@
+#include "ticker_scheduler.h"
+#include <stdexcept>
+#include <algorithm>
+
+using namespace fpga_ticker_client;
+
+ticker_scheduler::ticker_scheduler(const clock::duration& period, const missed_deadline_policy policy,
+    const clock::time_point& start)
+    : period(period), policy(policy), deadline(start + period), last_lateness(clock::duration::zero())
+{
+    if (period <= clock::duration::zero()) {
+        throw std::invalid_argument("Ticker period must be positive");
+    }
+}
+
+size_t ticker_scheduler::wait(std::unique_lock<std::mutex>& lock, std::condition_variable& cv,
+    const std::function<bool()>& stop_requested)
+{
+    if (cv.wait_until(lock, deadline, stop_requested)) {
+        return 0;
+    }
+    return advance(clock::now());
+}
+
+size_t ticker_scheduler::advance(const clock::time_point& now)
+{
+    if (now < deadline) {
+        return 0;
+    }
+
+    const auto elapsed = static_cast<size_t>((now - deadline) / period) + 1;
+    last_lateness = now - (deadline + period * (elapsed - 1));
+    deadline += period * elapsed;
+    return elapsed;
+}
+
+void ticker_scheduler::set_period(const clock::duration& new_period, const clock::time_point& now)
+{
+    if (new_period <= clock::duration::zero()) {
+        throw std::invalid_argument("Ticker period must be positive");
+    }
+    deadline = std::max(deadline - period + new_period, now);
+    period = new_period;
+}
+
+void ticker_scheduler::restart(const clock::time_point& first_deadline)
+{
+    deadline = first_deadline;
+}
+
+const ticker_scheduler::clock::time_point& ticker_scheduler::next_deadline() const
+{
+    return deadline;
+}
+
+const ticker_scheduler::clock::duration& ticker_scheduler::get_period() const
+{
+    return period;
+}
+
+const ticker_scheduler::clock::duration& ticker_scheduler::get_last_lateness() const
+{
+    return last_lateness;
+}
+
+missed_deadline_policy ticker_scheduler::get_policy() const
+{
+    return policy;
+}
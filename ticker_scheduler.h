@@ -0,0 +1,53 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_TICKER_SCHEDULER_H
+#define DDS_FPGA_TICKER_CLIENT_TICKER_SCHEDULER_H
+
+
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <cstddef>
+
+namespace fpga_ticker_client {
+    enum class missed_deadline_policy {
+        skip,       // send only the character due now, keeping position locked to the clock
+        catch_up    // send every character whose deadline was missed in one burst
+    };
+
+    class ticker_scheduler {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        explicit ticker_scheduler(const clock::duration& period,
+            const missed_deadline_policy policy = missed_deadline_policy::skip,
+            const clock::time_point& start = clock::now());
+
+        /*
+         * Sleeps until the next absolute deadline. Returns number of ticks elapsed since the previous deadline,
+         * or 0 once stop_requested holds (the waker must change what it checks under the same mutex).
+         */
+        size_t wait(std::unique_lock<std::mutex>& lock, std::condition_variable& cv,
+            const std::function<bool()>& stop_requested);
+        size_t advance(const clock::time_point& now);
+        // Next tick comes new period after the previous one, or at now if that already passed
+        void set_period(const clock::duration& new_period, const clock::time_point& now = clock::now());
+        // Next tick comes at first_deadline and later ones a period apart, for ticker that was paused or lost
+        void restart(const clock::time_point& first_deadline);
+
+        const clock::time_point& next_deadline() const;
+        const clock::duration& get_period() const;
+        // How late the most recent wake-up was after the deadline it served
+        const clock::duration& get_last_lateness() const;
+        missed_deadline_policy get_policy() const;
+
+    private:
+        clock::duration period;
+        const missed_deadline_policy policy;
+        clock::time_point deadline;
+        clock::duration last_lateness;
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_TICKER_SCHEDULER_H
@@ -0,0 +1,92 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+#include "ticker_scheduler.h"
+
+using namespace fpga_ticker_client;
+
+namespace {
+    using clock = ticker_scheduler::clock;
+    using std::chrono::milliseconds;
+
+    // Deadlines are absolute, so ticks missed by a late wake-up are counted rather than shifting later ones
+    int check_missed_ticks(const missed_deadline_policy policy)
+    {
+        const clock::time_point start = clock::now();
+        ticker_scheduler scheduler(milliseconds(10), policy, start);
+        if (scheduler.get_policy() != policy) {
+            std::cerr << "Policy was not kept" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (scheduler.advance(start + milliseconds(5)) != 0) {
+            std::cerr << "Tick before the first deadline" << std::endl;
+            return EXIT_FAILURE;
+        }
+        if ((scheduler.advance(start + milliseconds(10)) != 1)
+            || (scheduler.get_last_lateness() != clock::duration::zero())) {
+            std::cerr << "Tick at the first deadline was not one on time" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        // Deadlines at 20, 30 and 40 ms passed, the last one 5 ms ago
+        const size_t elapsed = scheduler.advance(start + milliseconds(45));
+        if (elapsed != 3) {
+            std::cerr << "Late wake-up counted " << elapsed << " ticks instead of 3" << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (scheduler.get_last_lateness() != milliseconds(5)) {
+            std::cerr << "Lateness was not measured from the last missed deadline" << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (scheduler.next_deadline() != start + milliseconds(50)) {
+            std::cerr << "Next deadline drifted after late wake-up" << std::endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    int check_period_change()
+    {
+        const clock::time_point start = clock::now();
+        ticker_scheduler scheduler(milliseconds(10), missed_deadline_policy::skip, start);
+        scheduler.advance(start + milliseconds(10));
+
+        scheduler.set_period(milliseconds(30), start + milliseconds(12));
+        if (scheduler.next_deadline() != start + milliseconds(40)) {
+            std::cerr << "Longer period does not count from the previous tick" << std::endl;
+            return EXIT_FAILURE;
+        }
+        // Next tick of a shorter period would already be in the past, it comes right away instead
+        scheduler.set_period(milliseconds(5), start + milliseconds(20));
+        if (scheduler.next_deadline() != start + milliseconds(20)) {
+            std::cerr << "Shorter period left next tick in the past" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        scheduler.restart(start + milliseconds(100));
+        if ((scheduler.advance(start + milliseconds(99)) != 0) || (scheduler.advance(start + milliseconds(106)) != 2)) {
+            std::cerr << "Ticks did not go on from restart deadline" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        try {
+            scheduler.set_period(clock::duration::zero());
+            std::cerr << "Zero period was accepted" << std::endl;
+            return EXIT_FAILURE;
+        } catch (const std::invalid_argument&) {
+        }
+        return EXIT_SUCCESS;
+    }
+}
+
+int main()
+{
+    if ((check_missed_ticks(missed_deadline_policy::skip) != EXIT_SUCCESS)
+        || (check_missed_ticks(missed_deadline_policy::catch_up) != EXIT_SUCCESS)
+        || (check_period_change() != EXIT_SUCCESS)) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,139 @@
+#include "upload_protocol.h"
+#include <array>
+#include <stdexcept>
+
+using namespace fpga_ticker_client;
+
+namespace {
+    using crc_table = std::array<uint32_t, 256>;
+
+    constexpr crc_table generate_crc_table()
+    {
+        crc_table table = { };
+        for (uint32_t index = 0; index < table.size(); ++index) {
+            uint32_t value = index;
+            for (int bit = 0; bit < 8; ++bit) {
+                value = (value & 1u) ? ((value >> 1) ^ 0xEDB88320u) : (value >> 1);
+            }
+            table[index] = value;
+        }
+        return table;
+    }
+
+    constexpr crc_table crc_values = generate_crc_table();
+
+    static_assert(crc_values[1] == 0x77073096u, "CRC table was not generated");
+
+    void put_le(std::vector<uint8_t>& bytes, const uint32_t value, const size_t size)
+    {
+        for (size_t byte_no = 0; byte_no < size; ++byte_no) {
+            bytes.push_back(static_cast<uint8_t>(value >> (8 * byte_no)));
+        }
+    }
+
+    uint32_t get_le(const uint8_t* bytes, const size_t size)
+    {
+        uint32_t value = 0;
+        for (size_t byte_no = 0; byte_no < size; ++byte_no) {
+            value |= static_cast<uint32_t>(bytes[byte_no]) << (8 * byte_no);
+        }
+        return value;
+    }
+}
+
+uint32_t fpga_ticker_client::crc32(const uint8_t* bytes, const size_t count, const uint32_t crc)
+{
+    uint32_t value = ~crc;
+    for (size_t byte_no = 0; byte_no < count; ++byte_no) {
+        value = crc_values[(value ^ bytes[byte_no]) & 0xFFu] ^ (value >> 8);
+    }
+    return ~value;
+}
+
+std::vector<uint8_t> upload_frame::serialize() const
+{
+    if (symbols.empty() || (symbols.size() > max_symbols)) {
+        throw std::invalid_argument("Uploaded text must encode to 1.." + std::to_string(max_symbols) + " symbols");
+    }
+    if ((period.count() <= 0) || (period.count() > UINT32_MAX)) {
+        throw std::invalid_argument("Uploaded period is out of range");
+    }
+
+    std::vector<uint8_t> bytes;
+    bytes.reserve(header_size + symbols.size() + checksum_size);
+    bytes.insert(bytes.end(), std::begin(magic), std::end(magic));
+    bytes.push_back(version);
+    bytes.push_back(0);
+    put_le(bytes, static_cast<uint32_t>(period.count()), 4);
+    put_le(bytes, static_cast<uint32_t>(symbols.size()), 2);
+    bytes.insert(bytes.end(), symbols.begin(), symbols.end());
+    put_le(bytes, crc32(bytes.data() + sizeof(magic), bytes.size() - sizeof(magic)), checksum_size);
+    return bytes;
+}
+
+upload_frame_parser::upload_frame_parser() : expected_size(upload_frame::header_size), skipped_bytes(0)
+{ }
+
+upload_frame_parser::status upload_frame_parser::feed(const uint8_t byte, const clock::time_point& arrival)
+{
+    const bool timed_out = !buffer.empty() && (arrival - last_arrival > frame_timeout);
+    last_arrival = arrival;
+    if (timed_out) {
+        skipped_bytes += buffer.size();
+        reset();
+    }
+
+    // Resynchronise on magic, a lost byte costs one frame at most
+    if ((buffer.size() < sizeof(upload_frame::magic)) && (byte != upload_frame::magic[buffer.size()])) {
+        skipped_bytes += buffer.size() + 1;
+        reset();
+        if (byte == upload_frame::magic[0]) {
+            --skipped_bytes;
+            buffer.push_back(byte);
+        }
+        return status::incomplete;
+    }
+
+    buffer.push_back(byte);
+    if ((buffer.size() == sizeof(upload_frame::magic) + 1) && (byte != upload_frame::version)) {
+        reset();
+        return status::corrupted;
+    }
+    if (buffer.size() == upload_frame::header_size) {
+        const size_t symbol_count = get_le(buffer.data() + 8, 2);
+        if (symbol_count == 0) {
+            reset();
+            return status::corrupted;
+        }
+        expected_size = upload_frame::header_size + symbol_count + upload_frame::checksum_size;
+    }
+    if (buffer.size() < expected_size) {
+        return status::incomplete;
+    }
+
+    const size_t checked_size = buffer.size() - upload_frame::checksum_size - sizeof(upload_frame::magic);
+    const bool intact = crc32(buffer.data() + sizeof(upload_frame::magic), checked_size)
+        == get_le(buffer.data() + buffer.size() - upload_frame::checksum_size, upload_frame::checksum_size);
+    if (intact) {
+        frame.period = std::chrono::microseconds(get_le(buffer.data() + 4, 4));
+        frame.symbols.assign(buffer.begin() + upload_frame::header_size, buffer.end() - upload_frame::checksum_size);
+    }
+    reset();
+    return intact ? status::complete : status::corrupted;
+}
+
+const upload_frame& upload_frame_parser::get_frame() const
+{
+    return frame;
+}
+
+size_t upload_frame_parser::get_skipped_bytes() const
+{
+    return skipped_bytes;
+}
+
+void upload_frame_parser::reset()
+{
+    buffer.clear();
+    expected_size = upload_frame::header_size;
+}
@@ -0,0 +1,67 @@
+#ifndef DDS_FPGA_TICKER_CLIENT_UPLOAD_PROTOCOL_H
+#define DDS_FPGA_TICKER_CLIENT_UPLOAD_PROTOCOL_H
+
+
+#include <vector>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace fpga_ticker_client {
+    /*
+     * Frame that boards with upload support loop by themselves, all numbers little-endian:
+     *
+     *   offset  size  field
+     *   0       2     magic 0xA5 0x5A
+     *   2       1     version
+     *   3       1     flags, reserved, zero
+     *   4       4     period of each symbol, microseconds
+     *   8       2     symbol count N
+     *   10      N     7-segment symbols
+     *   10 + N  4     CRC-32 (IEEE 802.3) of bytes from version to the last symbol
+     */
+    struct upload_frame {
+        static constexpr uint8_t magic[2] = { 0xA5, 0x5A };
+        static constexpr uint8_t version = 1;
+        static constexpr size_t header_size = 10, checksum_size = 4;
+        static constexpr size_t max_symbols = UINT16_MAX;
+
+        std::chrono::microseconds period = std::chrono::microseconds::zero();
+        std::vector<uint8_t> symbols;
+
+        std::vector<uint8_t> serialize() const;
+    };
+
+    uint32_t crc32(const uint8_t* bytes, const size_t count, const uint32_t crc = 0);
+
+    /*
+     * Receiving side state machine, fed byte by byte. Bytes outside of frames are skipped until next magic,
+     * partial frame is dropped when line stays idle longer than frame_timeout in the middle of it.
+     */
+    class upload_frame_parser {
+    public:
+        using clock = std::chrono::steady_clock;
+        enum class status { incomplete, complete, corrupted };
+
+        static constexpr clock::duration frame_timeout = std::chrono::milliseconds(100);
+
+        upload_frame_parser();
+
+        status feed(const uint8_t byte, const clock::time_point& arrival);
+        // Frame completed by last feed
+        const upload_frame& get_frame() const;
+        size_t get_skipped_bytes() const;
+
+    private:
+        void reset();
+
+        std::vector<uint8_t> buffer;
+        size_t expected_size;
+        size_t skipped_bytes;
+        clock::time_point last_arrival;
+        upload_frame frame;
+    };
+}
+
+
+#endif //DDS_FPGA_TICKER_CLIENT_UPLOAD_PROTOCOL_H